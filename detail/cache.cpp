@@ -0,0 +1,95 @@
+// Implementation of core/detail/cache.h.
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "cache.h"
+
+namespace core { namespace detail { namespace cache {
+
+void key::add_bytes( const void * data, std::size_t size ) {
+    const unsigned char * bytes = static_cast<const unsigned char *>( data );
+    for( std::size_t i = 0; i < size; i++ ) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+void key::add( const std::string& str ) {
+    add( (long long) str.size() );
+    add_bytes( str.data(), str.size() );
+}
+
+void key::add( long long value ) {
+    // Byte by byte, so the key does not depend on the endianness.
+    unsigned char bytes[8];
+    for( int i = 0; i < 8; i++ )
+        bytes[i] = (unsigned long long) value >> (8 * i);
+    add_bytes( bytes, 8 );
+}
+
+std::string build_identity() {
+#ifdef __linux__
+    std::ifstream exe( "/proc/self/exe", std::ios::binary );
+    if( exe ) {
+        key k;
+        std::string chunk( 1 << 16, '\0' );
+        while( exe.read( &chunk[0], chunk.size() ) || exe.gcount() > 0 )
+            k.add( chunk.substr( 0, exe.gcount() ) );
+        std::ostringstream id;
+        id << std::hex << k.value();
+        return id.str();
+    }
+#endif
+    return __DATE__ " " __TIME__;
+}
+
+bool lookup( const char * path, const key& k, int player_count, results& out ) {
+    std::ifstream in( path );
+    std::string line;
+    bool found = false;
+    while( std::getline(in, line) ) {
+        std::istringstream fields( line );
+        std::uint64_t line_key;
+        int count;
+        int truncated;
+        if( !(fields >> std::hex >> line_key >> std::dec >> count >> truncated) )
+            continue;
+        if( line_key != k.value() || count != player_count )
+            continue;
+
+        results r;
+        r.truncated = truncated;
+        r.first.resize( count );
+        r.second.resize( count );
+        r.third.resize( count );
+        for( int i = 0; i < count; i++ )
+            fields >> r.first[i] >> r.second[i] >> r.third[i];
+        if( !fields )
+            continue;
+
+        out = std::move(r);
+        found = true;
+    }
+    return found;
+}
+
+bool store( const char * path, const key& k, const results& r ) {
+    std::ostringstream line;
+    line << std::hex << k.value() << std::dec << ' ' << r.first.size()
+        << ' ' << r.truncated;
+    for( unsigned i = 0; i < r.first.size(); i++ )
+        line << ' ' << r.first[i] << ' ' << r.second[i] << ' ' << r.third[i];
+    line << '\n';
+
+    /* A single write of a short line in append mode,
+     * so concurrent runs sharing the cache do not interleave lines.
+     */
+    std::FILE * file = std::fopen( path, "a" );
+    if( !file )
+        return false;
+    std::string text = line.str();
+    bool ok = std::fwrite( text.data(), 1, text.size(), file ) == text.size();
+    return std::fclose( file ) == 0 && ok;
+}
+
+}}} // namespace core::detail::cache
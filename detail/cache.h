@@ -0,0 +1,70 @@
+#ifndef CORE_DETAIL_CACHE_H
+#define CORE_DETAIL_CACHE_H
+
+/* On-disk cache of aggregated results of several games.
+ *
+ * A matchup is identified by a hash of everything that can change its outcome:
+ * the build of the engine, the engine settings,
+ * and the name, command line arguments and build of each player,
+ * in seat order.
+ * The builds are identities given on the command line;
+ * the engine's defaults to build_identity(), and a player's to none.
+ * If a matchup was already played, its results are read from the cache
+ * instead of playing all the games again.
+ *
+ * The cache file has one line per matchup, of the form
+ *      <key> <player count> <truncated> <first_0> <second_0> <third_0> <first_1> ...
+ * with the key in hexadecimal.
+ * New results are appended; if a key appears more than once,
+ * the last line wins.
+ */
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace core { namespace detail { namespace cache {
+
+    /* Incremental 64-bit FNV-1a hash.
+     * Every string is hashed together with its length,
+     * so ("ab", "c") and ("a", "bc") give different keys.
+     */
+    class key {
+        std::uint64_t hash = 14695981039346656037ull;
+        void add_bytes( const void *, std::size_t );
+    public:
+        void add( const std::string& );
+        void add( long long );
+        std::uint64_t value() const { return hash; }
+    };
+
+    /* Identity of the running program.
+     *
+     * On Linux, this is a hash of the contents of /proc/self/exe;
+     * elsewhere it is the compilation date and time of this file.
+     */
+    std::string build_identity();
+
+    /* Aggregated results of a matchup, indexed by seat. */
+    struct results {
+        std::vector<int> first;
+        std::vector<int> second;
+        std::vector<int> third;
+
+        /* Number of games stopped by the round cap or the stall detection. */
+        int truncated = 0;
+    };
+
+    /* Searches the cache file for the given key,
+     * among the entries for a table with 'player_count' players.
+     * Returns true and fills 'out' if found.
+     */
+    bool lookup( const char * path, const key&, int player_count, results& out );
+
+    /* Appends the results to the cache file.
+     * Returns false if the file could not be written.
+     */
+    bool store( const char * path, const key&, const results& );
+
+}}} // namespace core::detail::cache
+
+#endif // CORE_DETAIL_CACHE_H
@@ -0,0 +1,131 @@
+// Implementation of core/detail/checkpoint.h.
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "checkpoint.h"
+#include "core/detail/file.h"
+
+namespace core { namespace detail { namespace checkpoint {
+
+/* File format:
+ *
+ *      porrinha-checkpoint 2
+ *      key <hexadecimal key>
+ *      games <games_completed>
+ *      tally <player count> <truncated> <first_0> <second_0> <third_0> ...
+ *      positions <count>
+ *      ratings <size in bytes>
+ *      <contents of the ratings file>
+ *
+ * The positions file is in the format of save_states.
+ */
+
+namespace {
+    std::thread writer;
+    std::atomic<bool> busy( false );
+    std::atomic<bool> failed( false );
+
+    bool save( const std::string& path, const snapshot& s ) {
+        std::string ratings = rating::format( s.ratings );
+        std::ostringstream out;
+        out << "porrinha-checkpoint 2\n"
+            << "key " << std::hex << s.key << std::dec << '\n'
+            << "games " << s.games_completed << '\n'
+            << "tally " << s.tally.first.size() << ' ' << s.tally.truncated;
+        for( unsigned i = 0; i < s.tally.first.size(); i++ )
+            out << ' ' << s.tally.first[i]
+                << ' ' << s.tally.second[i]
+                << ' ' << s.tally.third[i];
+        out << "\npositions " << s.position_count << '\n'
+            << "ratings " << ratings.size() << '\n'
+            << ratings;
+        return replace_file( path, out.str() );
+    }
+} // anonymous namespace
+
+bool write_positions( const std::string& path, const std::vector<game_state>& states ) {
+    return save_states( (path + ".positions").c_str(), states );
+}
+
+bool write( const std::string& path, snapshot&& s ) {
+    if( busy )
+        return false;
+    if( writer.joinable() )
+        writer.join();
+
+    busy = true;
+    writer = std::thread( [path]( snapshot s ) {
+        failed = !save( path, s );
+        busy = false;
+    }, std::move(s) );
+    return true;
+}
+
+bool wait() {
+    if( writer.joinable() )
+        writer.join();
+    return !failed;
+}
+
+bool read( const std::string& path, int player_count, snapshot& s,
+        std::vector<game_state>& start_states, std::string& error )
+{
+    std::ifstream in( path );
+    if( !in )
+        return false;
+
+    auto malformed = [&]( const char * what ) {
+        error = path + ": malformed checkpoint (" + what + ")";
+        return false;
+    };
+
+    std::string word;
+    int version;
+    if( !(in >> word >> version) || word != "porrinha-checkpoint" || version != 2 )
+        return malformed( "header" );
+    if( !(in >> word >> std::hex >> s.key >> std::dec) || word != "key" )
+        return malformed( "key" );
+    if( !(in >> word >> s.games_completed) || word != "games" )
+        return malformed( "games" );
+
+    int count;
+    if( !(in >> word >> count >> s.tally.truncated) || word != "tally" || count != player_count )
+        return malformed( "tally" );
+    s.tally.first.resize( count );
+    s.tally.second.resize( count );
+    s.tally.third.resize( count );
+    for( int i = 0; i < count; i++ )
+        in >> s.tally.first[i] >> s.tally.second[i] >> s.tally.third[i];
+    if( !in )
+        return malformed( "tally" );
+
+    if( !(in >> word >> s.position_count) || word != "positions" )
+        return malformed( "positions" );
+
+    std::size_t size;
+    if( !(in >> word >> size) || word != "ratings" )
+        return malformed( "ratings" );
+    in.get(); // newline
+    std::string ratings( size, '\0' );
+    if( size != 0 && !in.read( &ratings[0], size ) )
+        return malformed( "ratings" );
+    if( !rating::parse( ratings, s.ratings ) )
+        return malformed( "ratings" );
+
+    start_states.clear();
+    if( s.position_count != 0 ) {
+        std::string positions_error;
+        if( !load_states( (path + ".positions").c_str(), player_count,
+                    start_states, positions_error ) ) {
+            error = positions_error;
+            return false;
+        }
+        if( (int) start_states.size() != s.position_count )
+            return malformed( "positions" );
+    }
+
+    return true;
+}
+
+}}} // namespace core::detail::checkpoint
@@ -0,0 +1,78 @@
+#ifndef CORE_DETAIL_CHECKPOINT_H
+#define CORE_DETAIL_CHECKPOINT_H
+
+/* Checkpoints of a run of several games.
+ *
+ * A checkpoint holds everything needed to continue the run
+ * as if it had not been interrupted:
+ * the number of games already accounted, their tally,
+ * the positions the games start from
+ * (so sampled positions need not be sampled again)
+ * and the ratings.
+ *
+ * The positions do not change during a run,
+ * so they are written once, to "<path>.positions",
+ * and the checkpoint only records how many there are.
+ * The rest is copied by the game loop and written by a background thread,
+ * first to "<path>.tmp" and then renamed over the checkpoint,
+ * so the file on disk is always a complete checkpoint.
+ *
+ * The internal state of the players is not part of the checkpoint;
+ * after resuming, they start afresh.
+ */
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/detail/cache.h"
+#include "core/detail/rating.h"
+#include "core/detail/state.h"
+
+namespace core { namespace detail { namespace checkpoint {
+
+    struct snapshot {
+        /* Key of the matchup (see cache.h),
+         * so a checkpoint is only resumed by the same run.
+         */
+        std::uint64_t key;
+
+        /* Number of games already accounted in 'tally'. */
+        int games_completed;
+
+        cache::results tally;
+
+        /* Number of positions in "<path>.positions". */
+        int position_count;
+
+        /* See rating::snapshot; empty if the players are not being rated. */
+        rating::table ratings;
+    };
+
+    /* Writes the positions of the run to "<path>.positions".
+     * Called once, before the first checkpoint.
+     * Returns false if the file could not be written.
+     */
+    bool write_positions( const std::string& path, const std::vector<game_state>& );
+
+    /* Starts writing the snapshot in the background.
+     *
+     * If the previous checkpoint is still being written,
+     * this one is discarded instead of waiting, and false is returned.
+     */
+    bool write( const std::string& path, snapshot&& );
+
+    /* Waits for the checkpoint being written, if any.
+     * Returns false if the last checkpoint written could not be saved.
+     */
+    bool wait();
+
+    /* Reads a checkpoint for a table with 'player_count' players,
+     * and its positions into 'start_states'.
+     * Returns false if the file does not exist or is malformed;
+     * in the latter case, 'error' describes the problem.
+     */
+    bool read( const std::string& path, int player_count, snapshot&,
+            std::vector<game_state>& start_states, std::string& error );
+
+}}} // namespace core::detail::checkpoint
+
+#endif // CORE_DETAIL_CHECKPOINT_H
@@ -0,0 +1,230 @@
+// Implementation of core/detail/dataset.h.
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "dataset.h"
+#include "core/detail/variables.h"
+
+namespace core { namespace detail { namespace dataset {
+
+bool active = false;
+
+namespace {
+    // Fixed columns, before the per-player ones.
+    enum column {
+        GAME,
+        ROUND,
+        SEAT,
+        KIND,
+        ACTION,
+        LAST_WINNER,
+        RANK,
+        FIXED_COLUMNS,
+    };
+
+    const unsigned block_rows = 1 << 16;
+
+    /* Blocks waiting to be written.
+     * When this many are pending, the engine waits for the writer.
+     */
+    const unsigned max_pending_blocks = 4;
+
+    int width;
+
+    /* Rows of the calling thread's game, stored row after row.
+     * The game number and the rank are filled in by end_game.
+     */
+    thread_local std::vector<int> game_rows;
+
+    /* Rows of finished games not yet handed to the writer,
+     * and the number of the next game to be appended to it.
+     */
+    std::mutex block_mutex;
+    std::vector<int> block;
+    long long game_id;
+
+    std::FILE * file;
+    bool failed;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable block_ready;
+    std::condition_variable space_ready;
+    std::deque< std::vector<int> > pending;
+    bool closing;
+
+    void put_u32( std::string& out, std::uint32_t value ) {
+        for( int i = 0; i < 4; i++ )
+            out.push_back( char(value >> (8 * i)) );
+    }
+
+    /* Writes the value as a zigzag LEB128 varint;
+     * returns the position after it.
+     */
+    unsigned char * put_varint( unsigned char * out, long long value ) {
+        std::uint64_t zigzag = ((std::uint64_t) value << 1) ^ (std::uint64_t)(value >> 63);
+        while( zigzag >= 0x80 ) {
+            *out++ = zigzag | 0x80;
+            zigzag >>= 7;
+        }
+        *out++ = zigzag;
+        return out;
+    }
+
+    /* Writes to the file, remembering any failure for close. */
+    void write( const void * data, std::size_t size ) {
+        if( std::fwrite( data, 1, size, file ) != size )
+            failed = true;
+    }
+
+    void write_block( const std::vector<int>& rows ) {
+        std::size_t count = rows.size() / width;
+        std::string header;
+        put_u32( header, count );
+        write( header.data(), header.size() );
+
+        // A varint of an int takes at most 5 bytes.
+        std::vector< unsigned char > column( 4 + 5 * count );
+
+        for( int c = 0; c < width; c++ ) {
+            unsigned char * end = column.data() + 4;
+            const int * value = rows.data() + c;
+            if( c == GAME ) {
+                long long previous = 0;
+                for( std::size_t r = 0; r < count; r++, value += width ) {
+                    end = put_varint( end, *value - previous );
+                    previous = *value;
+                }
+            }
+            else
+                for( std::size_t r = 0; r < count; r++, value += width )
+                    end = put_varint( end, *value );
+
+            std::uint32_t size = end - column.data() - 4;
+            for( int i = 0; i < 4; i++ )
+                column[i] = size >> (8 * i);
+            write( column.data(), end - column.data() );
+        }
+    }
+
+    void writer_loop() {
+        std::unique_lock< std::mutex > lock( mutex );
+        while( true ) {
+            block_ready.wait( lock, []{ return closing || !pending.empty(); } );
+            if( pending.empty() )
+                return;
+
+            std::vector<int> rows = std::move( pending.front() );
+            pending.pop_front();
+            space_ready.notify_one();
+
+            lock.unlock();
+            write_block( rows );
+            lock.lock();
+        }
+    }
+
+    /* Hands the current block to the writer thread.
+     * Must be called with block_mutex locked.
+     */
+    void submit_block() {
+        std::unique_lock< std::mutex > lock( mutex );
+        space_ready.wait( lock, []{ return pending.size() < max_pending_blocks; } );
+        pending.push_back( std::move(block) );
+        block_ready.notify_one();
+
+        block = std::vector<int>();
+        block.reserve( block_rows * width );
+    }
+} // anonymous namespace
+
+bool open( const char * path ) {
+    file = std::fopen( path, "wb" );
+    if( !file )
+        return false;
+
+    width = FIXED_COLUMNS + 3 * players.size();
+    game_id = 0;
+    game_rows.clear();
+    block.clear();
+    block.reserve( block_rows * width );
+
+    failed = false;
+    std::string header( "PORRDS1", 8 );
+    put_u32( header, players.size() );
+    write( header.data(), header.size() );
+
+    closing = false;
+    writer = std::thread( writer_loop );
+    active = true;
+    return true;
+}
+
+void record( decision kind, int player, int action ) {
+    std::size_t begin = game_rows.size();
+    game_rows.resize( begin + width );
+    int * row = game_rows.data() + begin;
+
+    row[GAME] = -1;
+    row[ROUND] = round_count;
+    row[SEAT] = player;
+    row[KIND] = kind;
+    row[ACTION] = action;
+    row[LAST_WINNER] = last_winner;
+    row[RANK] = -1;
+    row = std::copy( chopsticks.begin(), chopsticks.end(), row + FIXED_COLUMNS );
+    row = std::copy( guesses.begin(), guesses.end(), row );
+    std::copy( last_hand.begin(), last_hand.end(), row );
+}
+
+void end_game( const std::vector<int>& ranking ) {
+    if( !active )
+        return;
+
+    std::vector<int> rank( ranking.size() );
+    for( unsigned i = 0; i < ranking.size(); i++ )
+        rank[ranking[i]] = i;
+
+    for( std::size_t row = 0; row < game_rows.size(); row += width )
+        game_rows[row + RANK] = rank[game_rows[row + SEAT]];
+
+    std::lock_guard< std::mutex > lock( block_mutex );
+    for( std::size_t row = 0; row < game_rows.size(); row += width )
+        game_rows[row + GAME] = game_id;
+    game_id++;
+
+    block.insert( block.end(), game_rows.begin(), game_rows.end() );
+    game_rows.clear();
+
+    if( block.size() >= block_rows * width )
+        submit_block();
+}
+
+bool close() {
+    if( !active )
+        return true;
+
+    {
+        std::lock_guard< std::mutex > lock( block_mutex );
+        if( !block.empty() )
+            submit_block();
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+        closing = true;
+    }
+    block_ready.notify_one();
+    writer.join();
+
+    if( std::fclose( file ) != 0 )
+        failed = true;
+    active = false;
+    return !failed;
+}
+
+}}} // namespace core::detail::dataset
@@ -0,0 +1,84 @@
+#ifndef CORE_DETAIL_DATASET_H
+#define CORE_DETAIL_DATASET_H
+
+/* Export of every decision of the players, as training data.
+ *
+ * For each call to Player::hand and Player::guess,
+ * one row is recorded with the state visible to the player
+ * (the values of core::chopsticks(), core::guess() so far,
+ * core::hand() and core::last_winner()),
+ * the action it took (after the engine's sanity checks)
+ * and its final rank in that game.
+ *
+ * Rows are collected by the engine into blocks of 65536
+ * and handed to a background thread,
+ * which transposes them into columns, encodes and writes them;
+ * the engine thread only copies a few integers per decision.
+ * Several threads may run games at once;
+ * each game's rows are kept together and numbered in the order
+ * the games end.
+ *
+ * File format (all integers little-endian):
+ *
+ *  header: the 8 bytes "PORRDS1\0", then the number of players n as u32.
+ *  blocks, until the end of the file:
+ *      u32 row count,
+ *      then, for each of the 7 + 3n columns, a u32 byte length
+ *      followed by the column's values as zigzag LEB128 varints.
+ *
+ * The columns are, in order:
+ *      game (delta-encoded from the previous row; the first row of a block
+ *            is a delta from zero), round, seat,
+ *      kind (0 for hand, 1 for guess), action, last_winner, rank,
+ *      chopsticks_0 ... chopsticks_n-1,
+ *      guess_0 ... guess_n-1,
+ *      hand_0 ... hand_n-1.
+ * Most values fit in a single byte, so the file is about
+ * (7 + 3n) bytes per decision.
+ */
+#include <vector>
+
+namespace core { namespace detail { namespace dataset {
+
+    enum decision {
+        HAND = 0,
+        GUESS = 1,
+    };
+
+    /* Whether the decisions are being recorded. */
+    extern bool active;
+
+    /* Opens the file and starts the writer thread.
+     * Returns false if the file could not be opened.
+     *
+     * Variables assumed valid:
+     *  players
+     */
+    bool open( const char * path );
+
+    /* Records a decision of the given player.
+     * Must be called before the action is stored in the engine's variables,
+     * so the state recorded is the one the player saw.
+     *
+     * Variables assumed valid:
+     *  chopsticks
+     *  guesses
+     *  last_hand
+     *  last_winner
+     *  round_count
+     */
+    void record( decision, int player, int action );
+
+    /* Completes the rows of the game that has just ended
+     * with the final rank of each player.
+     */
+    void end_game( const std::vector<int>& ranking );
+
+    /* Writes every pending row and stops the writer thread.
+     * Returns false if any of the file could not be written.
+     */
+    bool close();
+
+}}} // namespace core::detail::dataset
+
+#endif // CORE_DETAIL_DATASET_H
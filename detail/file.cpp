@@ -0,0 +1,23 @@
+// Implementation of core/detail/file.h.
+#include <cstdio>
+#include "file.h"
+
+namespace core { namespace detail {
+
+bool replace_file( const std::string& path, const std::string& contents ) {
+    std::string temporary = path + ".tmp";
+    std::FILE * file = std::fopen( temporary.c_str(), "w" );
+    if( !file )
+        return false;
+
+    bool written = std::fwrite( contents.data(), 1, contents.size(), file ) == contents.size();
+    if( std::fclose( file ) != 0 )
+        written = false;
+    if( !written ) {
+        std::remove( temporary.c_str() );
+        return false;
+    }
+    return std::rename( temporary.c_str(), path.c_str() ) == 0;
+}
+
+}} // namespace core::detail
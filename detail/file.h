@@ -0,0 +1,21 @@
+#ifndef CORE_DETAIL_FILE_H
+#define CORE_DETAIL_FILE_H
+
+/* Atomic replacement of files that are read while the program runs
+ * (ratings, checkpoints, metrics).
+ */
+#include <string>
+
+namespace core { namespace detail {
+
+    /* Writes 'contents' to "<path>.tmp", flushes and closes it,
+     * and only then renames it over 'path',
+     * so readers see either the old file or the whole new one.
+     *
+     * Returns false if any step fails; 'path' is then left untouched.
+     */
+    bool replace_file( const std::string& path, const std::string& contents );
+
+}} // namespace core::detail
+
+#endif // CORE_DETAIL_FILE_H
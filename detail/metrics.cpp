@@ -0,0 +1,180 @@
+// Implementation of core/detail/metrics.h.
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "metrics.h"
+#include "core/detail/file.h"
+#include "core/detail/variables.h"
+
+namespace core { namespace detail { namespace metrics {
+
+bool active = false;
+
+namespace {
+    typedef std::chrono::steady_clock clock;
+    typedef std::atomic<long long> counter;
+
+    const std::memory_order relaxed = std::memory_order_relaxed;
+
+    counter games( 0 );
+    counter rounds( 0 );
+    counter truncated_games( 0 );
+
+    // Indexed by seat.
+    int seats;
+    std::unique_ptr<counter[]> invalid_hand_count;
+    std::unique_ptr<counter[]> invalid_guess_count;
+    std::unique_ptr<counter[]> wins;
+
+    // Label of each seat, as in seat="0",player="name".
+    std::vector<std::string> labels;
+
+    std::string file_path;
+    std::chrono::duration<double> period;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool closing;
+
+    clock::time_point start_time;
+    clock::time_point last_time;
+    long long last_games;
+
+    std::string label( int seat, const std::string& name ) {
+        std::string escaped;
+        for( char c : name ) {
+            if( c == '\\' || c == '"' )
+                escaped += '\\';
+            if( c == '\n' )
+                escaped += "\\n";
+            else
+                escaped += c;
+        }
+        return "seat=\"" + std::to_string(seat) + "\",player=\"" + escaped + "\"";
+    }
+
+    template< typename T >
+    void put_metric( std::ostream& out, const char * name, const char * type,
+            const char * help, T value )
+    {
+        out << "# HELP " << name << ' ' << help << '\n'
+            << "# TYPE " << name << ' ' << type << '\n'
+            << name << ' ' << value << '\n';
+    }
+
+    void put_seat_metric( std::ostream& out, const char * name,
+            const char * help, const counter * values )
+    {
+        out << "# HELP " << name << ' ' << help << '\n'
+            << "# TYPE " << name << " counter\n";
+        for( int i = 0; i < seats; i++ )
+            out << name << '{' << labels[i] << "} " << values[i].load( relaxed ) << '\n';
+    }
+
+    /* Writes every metric to the file.
+     * Only called by the writer thread (or after it stopped).
+     */
+    bool dump() {
+        clock::time_point now = clock::now();
+        long long games_now = games.load( relaxed );
+        double elapsed = std::chrono::duration<double>( now - last_time ).count();
+        double rate = elapsed > 0 ? (games_now - last_games) / elapsed : 0.0;
+        last_time = now;
+        last_games = games_now;
+
+        std::ostringstream out;
+        put_metric( out, "porrinha_games_completed_total", "counter",
+                "Games completed.", games_now );
+        put_metric( out, "porrinha_rounds_completed_total", "counter",
+                "Rounds of the completed games.", rounds.load( relaxed ) );
+        put_metric( out, "porrinha_games_truncated_total", "counter",
+                "Games stopped by the round limit or the stall detection.",
+                truncated_games.load( relaxed ) );
+        put_metric( out, "porrinha_games_per_second", "gauge",
+                "Games completed per second since the previous update.", rate );
+        put_metric( out, "porrinha_elapsed_seconds", "gauge",
+                "Time since the metrics were started.",
+                std::chrono::duration<double>( now - start_time ).count() );
+        put_seat_metric( out, "porrinha_invalid_hands_total",
+                "Invalid hands replaced by the engine.", invalid_hand_count.get() );
+        put_seat_metric( out, "porrinha_invalid_guesses_total",
+                "Invalid guesses replaced by the engine.", invalid_guess_count.get() );
+        put_seat_metric( out, "porrinha_wins_total",
+                "Games won.", wins.get() );
+        return replace_file( file_path, out.str() );
+    }
+
+    void write_periodically() {
+        std::unique_lock< std::mutex > lock( mutex );
+        while( !closing ) {
+            wake.wait_for( lock, period );
+            if( !closing )
+                dump();
+        }
+    }
+} // anonymous namespace
+
+bool open( const char * path, double interval ) {
+    seats = players.size();
+    invalid_hand_count.reset( new counter[seats] );
+    invalid_guess_count.reset( new counter[seats] );
+    wins.reset( new counter[seats] );
+    labels.clear();
+    for( int i = 0; i < seats; i++ ) {
+        invalid_hand_count[i] = 0;
+        invalid_guess_count[i] = 0;
+        wins[i] = 0;
+        labels.push_back( label( i, players[i]->name() ) );
+    }
+
+    file_path = path;
+    period = std::chrono::duration<double>( interval );
+    start_time = last_time = clock::now();
+    last_games = 0;
+    if( !dump() )
+        return false;
+
+    closing = false;
+    writer = std::thread( write_periodically );
+    active = true;
+    return true;
+}
+
+void end_game( const std::vector<int>& ranking ) {
+    if( !active )
+        return;
+
+    games.fetch_add( 1, relaxed );
+    rounds.fetch_add( round_count, relaxed );
+    if( truncated )
+        truncated_games.fetch_add( 1, relaxed );
+    wins[ranking[0]].fetch_add( 1, relaxed );
+    for( int i = 0; i < seats; i++ ) {
+        if( invalid_hands[i] != 0 )
+            invalid_hand_count[i].fetch_add( invalid_hands[i], relaxed );
+        if( invalid_guesses[i] != 0 )
+            invalid_guess_count[i].fetch_add( invalid_guesses[i], relaxed );
+    }
+}
+
+void close() {
+    if( !active )
+        return;
+
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+        closing = true;
+    }
+    wake.notify_one();
+    writer.join();
+
+    dump();
+    active = false;
+}
+
+}}} // namespace core::detail::metrics
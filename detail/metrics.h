@@ -0,0 +1,54 @@
+#ifndef CORE_DETAIL_METRICS_H
+#define CORE_DETAIL_METRICS_H
+
+/* Live metrics of a run, for monitoring long tournaments.
+ *
+ * The engine adds each game to a few counters when it ends
+ * (games, rounds, truncated games, and per seat
+ * the invalid hands, invalid guesses and wins),
+ * with relaxed atomic additions, so every worker thread updates them
+ * without locks and nothing is done inside the rounds.
+ *
+ * A background thread periodically writes the counters,
+ * plus the games per second since the previous write,
+ * in the Prometheus text exposition format.
+ * It writes "<path>.tmp" and renames it over the file,
+ * so the file can be scraped at any moment
+ * (for instance, by node_exporter's textfile collector).
+ *
+ * Per-seat metrics are labeled with the seat and the player's name, like
+ *      porrinha_wins_total{seat="0",player="Rnd"} 1234
+ */
+#include <vector>
+
+namespace core { namespace detail { namespace metrics {
+
+    /* Whether the counters are being maintained. */
+    extern bool active;
+
+    /* Starts the thread that writes the metrics to the file
+     * every 'interval' seconds.
+     * Returns false if the file could not be written.
+     *
+     * Variables assumed valid:
+     *  players
+     */
+    bool open( const char * path, double interval );
+
+    /* Adds the game that has just ended to the counters.
+     * 'ranking' is the vector returned by run_game.
+     *
+     * Variables assumed valid:
+     *  round_count
+     *  invalid_hands
+     *  invalid_guesses
+     *  truncated
+     */
+    void end_game( const std::vector<int>& ranking );
+
+    /* Writes the metrics a last time and stops the thread. */
+    void close();
+
+}}} // namespace core::detail::metrics
+
+#endif // CORE_DETAIL_METRICS_H
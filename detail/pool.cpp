@@ -0,0 +1,67 @@
+// Implementation of core/detail/pool.h.
+#include <thread>
+#include "pool.h"
+#include "core/detail/variables.h"
+
+namespace core { namespace detail {
+
+player_pool::player_pool( std::vector<std::pair<PlayerFactory, cmdline::args>>&& list ) :
+    factories( std::move(list) )
+{}
+
+player_set player_pool::construct() {
+    /* Factories may query core::global_player_count,
+     * which must already return the final size of the set.
+     */
+    player_set previous = std::move( players );
+    players = player_set( factories.size() );
+
+    for( unsigned i = 0; i < factories.size(); i++ ) {
+        cmdline::args args = factories[i].second;
+        players[i].reset( factories[i].first( std::move(args) ) );
+    }
+
+    player_set set = std::move( players );
+    players = std::move( previous );
+    return set;
+}
+
+void player_pool::reserve( int count ) {
+    int missing;
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+        missing = count - idle.size();
+    }
+    if( missing <= 0 )
+        return;
+
+    std::vector<player_set> sets( missing );
+    std::vector<std::thread> threads;
+    for( int i = 0; i < missing; i++ )
+        threads.emplace_back( [this, &sets, i]{ sets[i] = construct(); } );
+    for( auto & thread : threads )
+        thread.join();
+
+    std::lock_guard< std::mutex > lock( mutex );
+    for( auto & set : sets )
+        idle.push_back( std::move(set) );
+}
+
+player_set player_pool::acquire() {
+    {
+        std::lock_guard< std::mutex > lock( mutex );
+        if( !idle.empty() ) {
+            player_set set = std::move( idle.back() );
+            idle.pop_back();
+            return set;
+        }
+    }
+    return construct();
+}
+
+void player_pool::release( player_set&& set ) {
+    std::lock_guard< std::mutex > lock( mutex );
+    idle.push_back( std::move(set) );
+}
+
+}} // namespace core::detail
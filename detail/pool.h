@@ -0,0 +1,62 @@
+#ifndef CORE_DETAIL_POOL_H
+#define CORE_DETAIL_POOL_H
+
+/* Pool of player sets.
+ *
+ * A player set is one instance of each player of the game,
+ * in seat order, constructed by its factory with its command line arguments.
+ * Each thread that runs games needs a set of its own;
+ * the pool constructs the sets once, concurrently,
+ * and keeps them between uses, so they are reused across games
+ * (through Player::begin_game and Player::end_game)
+ * instead of being constructed again.
+ *
+ * Players that load large read-only data should get it through
+ * core::shared_data, so every set shares a single copy.
+ */
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "player.h"
+
+namespace core { namespace detail {
+
+    typedef std::vector<std::unique_ptr<Player>> player_set;
+
+    class player_pool {
+        std::vector<std::pair<PlayerFactory, cmdline::args>> factories;
+        std::vector<player_set> idle;
+        std::mutex mutex;
+
+        /* Constructs a set in the calling thread.
+         *
+         * Updated variables:
+         *  players (of the calling thread; restored afterwards)
+         */
+        player_set construct();
+
+    public:
+        /* Each argument in the list is a pair<factory, args>;
+         * every set is constructed by calling the factories
+         * with a copy of the arguments they are paired with.
+         */
+        explicit player_pool( std::vector<std::pair<PlayerFactory, cmdline::args>>&& );
+
+        /* Ensures at least 'count' sets are idle,
+         * constructing the missing ones concurrently, one thread per set.
+         */
+        void reserve( int count );
+
+        /* Takes a set out of the pool;
+         * if there is none idle, one is constructed in the calling thread.
+         */
+        player_set acquire();
+
+        /* Gives back a set taken by acquire. */
+        void release( player_set&& );
+    };
+
+}} // namespace core::detail
+
+#endif // CORE_DETAIL_POOL_H
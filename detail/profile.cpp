@@ -0,0 +1,213 @@
+// Implementation of core/detail/profile.h.
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include "profile.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace core { namespace detail { namespace profile {
+
+bool active = false;
+
+namespace {
+    typedef std::chrono::steady_clock clock;
+
+    /* Hardware counters, in the order they are read from the group. */
+    enum counter {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        COUNTER_COUNT,
+    };
+
+    const char * const phase_names[PHASE_COUNT] = {
+        "hand collection",
+        "guess collection",
+        "winner accounting",
+        "end_round callbacks",
+        "output formatting",
+    };
+
+    struct totals {
+        clock::duration time = clock::duration::zero();
+        std::uint64_t counters[COUNTER_COUNT] = {};
+    };
+
+    /* Index PHASE_COUNT accumulates whatever runs outside any phase;
+     * it is discarded in the report.
+     */
+    thread_local totals accumulated[PHASE_COUNT + 1];
+
+    thread_local bool started = false;
+    thread_local phase current = PHASE_COUNT;
+    thread_local clock::time_point last_time;
+    thread_local std::uint64_t last_counters[COUNTER_COUNT];
+
+    /* File descriptors of the calling thread's counters;
+     * the first one is the group leader.
+     * -1 if the counters are not avaliable.
+     */
+    thread_local int counter_fd[COUNTER_COUNT] = { -1, -1, -1, -1 };
+
+    // Totals of the threads that called merge.
+    std::mutex merged_mutex;
+    totals merged[PHASE_COUNT];
+    bool counters_missing = false;
+
+#ifdef __linux__
+    int open_counter( std::uint64_t config, int group_fd ) {
+        perf_event_attr attr;
+        std::memset( &attr, 0, sizeof(attr) );
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return syscall( __NR_perf_event_open, &attr, 0, -1, group_fd, 0 );
+    }
+
+    void open_counters() {
+        const std::uint64_t configs[COUNTER_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for( int i = 0; i < COUNTER_COUNT; i++ ) {
+            counter_fd[i] = open_counter( configs[i], i == 0 ? -1 : counter_fd[0] );
+            if( counter_fd[i] == -1 ) {
+                for( int j = 0; j < i; j++ ) {
+                    close( counter_fd[j] );
+                    counter_fd[j] = -1;
+                }
+                return;
+            }
+        }
+    }
+
+    /* Reads the whole group with a single system call.
+     * Returns false, leaving 'values' untouched, if it could not be read.
+     */
+    bool read_counters( std::uint64_t * values ) {
+        if( counter_fd[0] == -1 )
+            return false;
+        std::uint64_t buffer[COUNTER_COUNT + 1];
+        if( read( counter_fd[0], buffer, sizeof(buffer) ) != sizeof(buffer) )
+            return false;
+        std::memcpy( values, buffer + 1, sizeof(std::uint64_t) * COUNTER_COUNT );
+        return true;
+    }
+#else
+    void open_counters() {}
+    bool read_counters( std::uint64_t * ) { return false; }
+    void close( int ) {}
+#endif
+
+    /* Opens the counters of the calling thread
+     * and starts measuring outside any phase.
+     */
+    void start() {
+        open_counters();
+        for( auto & value : last_counters )
+            value = 0;
+        read_counters( last_counters );
+        last_time = clock::now();
+        current = PHASE_COUNT;
+        started = true;
+    }
+} // anonymous namespace
+
+void enable() {
+    start();
+    active = true;
+}
+
+void merge() {
+    if( !started )
+        return;
+
+    std::lock_guard< std::mutex > lock( merged_mutex );
+    for( int p = 0; p < PHASE_COUNT; p++ ) {
+        merged[p].time += accumulated[p].time;
+        for( int i = 0; i < COUNTER_COUNT; i++ )
+            merged[p].counters[i] += accumulated[p].counters[i];
+        accumulated[p] = totals();
+    }
+    if( counter_fd[0] == -1 )
+        counters_missing = true;
+
+    for( auto & fd : counter_fd )
+        if( fd != -1 ) {
+            close( fd );
+            fd = -1;
+        }
+    started = false;
+}
+
+phase switch_to( phase next ) {
+    if( !started )
+        start();
+
+    std::uint64_t now_counters[COUNTER_COUNT];
+    bool counted = read_counters( now_counters );
+    clock::time_point now = clock::now();
+
+    totals & t = accumulated[current];
+    t.time += now - last_time;
+    last_time = now;
+
+    /* On a failed read, the counters since the last switch
+     * are added to the next phase that reads them.
+     */
+    if( counted )
+        for( int i = 0; i < COUNTER_COUNT; i++ ) {
+            t.counters[i] += now_counters[i] - last_counters[i];
+            last_counters[i] = now_counters[i];
+        }
+
+    phase previous = current;
+    current = next;
+    return previous;
+}
+
+void report( std::ostream& os ) {
+    merge();
+
+    clock::duration total = clock::duration::zero();
+    for( int p = 0; p < PHASE_COUNT; p++ )
+        total += merged[p].time;
+
+    os << "\n\tEngine profile:\n";
+    if( counters_missing )
+        os << "(hardware counters unavaliable; showing wall time only)\n"
+            << "Phase - milliseconds / share\n";
+    else
+        os << "Phase - milliseconds / share / cycles / instructions"
+            << " / cache misses / branch misses\n";
+
+    for( int p = 0; p < PHASE_COUNT; p++ ) {
+        const totals & t = merged[p];
+        double ms = std::chrono::duration<double, std::milli>( t.time ).count();
+        double share = total.count() == 0 ? 0.0 : 100.0 * t.time.count() / total.count();
+
+        os << phase_names[p] << " - "
+            << std::fixed << std::setprecision(3) << ms << " / "
+            << std::setprecision(1) << share << '%';
+        os.unsetf( std::ios_base::floatfield );
+        if( !counters_missing )
+            for( int i = 0; i < COUNTER_COUNT; i++ )
+                os << " / " << t.counters[i];
+        os << '\n';
+    }
+}
+
+}}} // namespace core::detail::profile
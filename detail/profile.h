@@ -0,0 +1,91 @@
+#ifndef CORE_DETAIL_PROFILE_H
+#define CORE_DETAIL_PROFILE_H
+
+/* Self-profiling of the engine.
+ *
+ * When enabled, the wall time spent in each phase of a round
+ * is accumulated separately.
+ * On Linux, the hardware counters for cycles, instructions,
+ * cache misses and branch misses are also read through perf_event_open
+ * and charged to the phase that was running.
+ *
+ * Phases nest: entering a phase pauses the accounting of the enclosing one,
+ * so the time spent printing the outcome of a round
+ * is not charged to, for instance, the winner accounting.
+ *
+ * When disabled (the default), each phase switch costs a single test.
+ *
+ * Each thread measures its own phases, with its own counters;
+ * threads that run games merge their measurements before finishing.
+ */
+#include <ostream>
+
+namespace core { namespace detail { namespace profile {
+
+    enum phase {
+        HAND_COLLECTION,
+        GUESS_COLLECTION,
+        WINNER_ACCOUNTING,
+        END_ROUND_CALLBACKS,
+        OUTPUT_FORMATTING,
+
+        /* Number of phases; also used to denote "outside any phase". */
+        PHASE_COUNT,
+    };
+
+    /* Whether the profiler is running. */
+    extern bool active;
+
+    /* Starts profiling.
+     * Other threads start measuring on their first phase switch.
+     * If the hardware counters cannot be opened
+     * (non-Linux system or insufficient permissions),
+     * only the wall time is measured.
+     */
+    void enable();
+
+    /* Charges everything measured since the last switch to the current phase
+     * and makes 'next' the current phase.
+     *
+     * Returns the phase that was current before the switch.
+     */
+    phase switch_to( phase next );
+
+    /* Adds the measurements of the calling thread to the report
+     * and releases its counters.
+     * Must be called by every thread that ran games, other than
+     * the one that calls 'report', before it finishes.
+     */
+    void merge();
+
+    /* Prints the accumulated statistics of each phase,
+     * summed over every thread.
+     */
+    void report( std::ostream& );
+
+    /* Marks the lifetime of this object as being spent in the given phase.
+     */
+    class scope {
+        phase previous;
+        bool engaged;
+    public:
+        explicit scope( phase p ) :
+            previous( PHASE_COUNT ),
+            engaged( active )
+        {
+            if( engaged )
+                previous = switch_to( p );
+        }
+
+        ~scope() {
+            if( engaged )
+                switch_to( previous );
+        }
+
+        scope( const scope& ) = delete;
+        scope& operator=( const scope& ) = delete;
+    };
+
+}}} // namespace core::detail::profile
+
+#endif // CORE_DETAIL_PROFILE_H
@@ -0,0 +1,153 @@
+// Implementation of core/detail/rating.h.
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "rating.h"
+#include "core/detail/file.h"
+#include "core/detail/variables.h"
+
+namespace core { namespace detail { namespace rating {
+
+namespace {
+    bool active = false;
+    std::string file_name;
+    double k;
+
+    /* Every rating read from the file or created in this run.
+     * Players not in this game are kept so they are written back.
+     */
+    table ratings;
+
+    /* Rating of each seat of this game; points into 'ratings'. */
+    std::vector< entry * > seat;
+
+    /* Per-seat scratch space for update. */
+    std::vector< double > delta;
+} // anonymous namespace
+
+namespace {
+    /* Reads the contents of a ratings file into 't'.
+     * Returns false if the contents are malformed.
+     */
+    bool parse( std::istream& in, table& t ) {
+        t.clear();
+        std::string line;
+        while( std::getline(in, line) ) {
+            if( line.empty() )
+                continue;
+            std::istringstream fields( line );
+            entry e;
+            std::string name;
+            if( !(fields >> e.rating >> e.games) )
+                return false;
+            fields >> std::ws;
+            std::getline( fields, name );
+            if( name.empty() )
+                return false;
+            t[name] = e;
+        }
+        return true;
+    }
+} // anonymous namespace
+
+bool load( const char * path, double k_factor ) {
+    file_name = path;
+    k = k_factor;
+
+    std::ifstream in( path );
+    table t;
+    if( !parse( in, t ) )
+        return false;
+
+    active = true;
+    restore( t );
+    return true;
+}
+
+table snapshot() {
+    if( !active )
+        return table();
+    return ratings;
+}
+
+void restore( const table& t ) {
+    ratings = t;
+    seat.resize( players.size() );
+    for( unsigned i = 0; i < players.size(); i++ )
+        seat[i] = &ratings[players[i]->name()];
+    delta.resize( players.size() );
+}
+
+std::string format( const table& t ) {
+    std::ostringstream out;
+    out << std::setprecision(17);
+    for( const auto & pair : t )
+        out << pair.second.rating << ' ' << pair.second.games
+            << ' ' << pair.first << '\n';
+    return out.str();
+}
+
+bool parse( const std::string& contents, table& t ) {
+    std::istringstream in( contents );
+    return parse( in, t );
+}
+
+void update( const std::vector<int>& ranking ) {
+    if( !active )
+        return;
+
+    std::fill( delta.begin(), delta.end(), 0.0 );
+    const double pair_k = k / (ranking.size() - 1);
+
+    for( unsigned i = 0; i < ranking.size(); i++ )
+    for( unsigned j = i + 1; j < ranking.size(); j++ ) {
+        entry * winner = seat[ranking[i]];
+        entry * loser = seat[ranking[j]];
+        if( winner == loser )
+            continue;
+
+        double expected = 1.0 / (1.0 + std::pow(10.0, (loser->rating - winner->rating) / 400.0));
+        double change = pair_k * (1.0 - expected);
+        delta[ranking[i]] += change;
+        delta[ranking[j]] -= change;
+    }
+
+    /* Deltas are computed from the ratings before the game,
+     * and only then applied, so the seat order does not matter.
+     */
+    for( unsigned i = 0; i < seat.size(); i++ ) {
+        seat[i]->rating += delta[i];
+
+        bool first_seat = true;
+        for( unsigned j = 0; j < i; j++ )
+            if( seat[j] == seat[i] )
+                first_seat = false;
+        if( first_seat )
+            seat[i]->games++;
+    }
+}
+
+bool save() {
+    if( !active )
+        return true;
+
+    return replace_file( file_name, format( ratings ) );
+}
+
+void report( std::ostream& os ) {
+    if( !active )
+        return;
+
+    os << "\n\tRatings:\n"
+        << "Player - rating / games rated\n";
+    for( unsigned i = 0; i < seat.size(); i++ )
+        os << players[i]->name() << " - "
+            << std::fixed << std::setprecision(1) << seat[i]->rating
+            << " / " << seat[i]->games << '\n';
+    os.unsetf( std::ios_base::floatfield );
+    os << std::setprecision(6);
+}
+
+}}} // namespace core::detail::rating
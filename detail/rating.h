@@ -0,0 +1,94 @@
+#ifndef CORE_DETAIL_RATING_H
+#define CORE_DETAIL_RATING_H
+
+/* Incremental rating of the players.
+ *
+ * Each game is treated as a set of pairwise matches:
+ * every player beats the players ranked below it.
+ * The ratings are then updated by the Elo formula,
+ * with the K factor divided among the N-1 opponents,
+ * so a game is worth one match regardless of the number of players.
+ *
+ * Ratings are keyed by Player::name and persisted to a text file,
+ * so each run resumes from the ratings of the previous one
+ * and a new player only needs enough games against rated opponents
+ * to converge.
+ * Seats occupied by players with the same name share a rating
+ * and are not rated against each other.
+ *
+ * The file has one line per player, of the form
+ *      <rating> <games> <name>
+ * where the name extends to the end of the line.
+ */
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace core { namespace detail { namespace rating {
+
+    /* Initial rating of players absent from the ratings file. */
+    const double initial_rating = 1500.0;
+
+    struct entry {
+        double rating = initial_rating;
+        long long games = 0;
+    };
+
+    /* Every rating, keyed by player name. */
+    typedef std::map< std::string, entry > table;
+
+    /* Reads the ratings file and starts rating the players.
+     * A missing file is treated as empty.
+     *
+     * Returns false if the file exists but is malformed.
+     *
+     * Variables assumed valid:
+     *  players
+     */
+    bool load( const char * path, double k_factor );
+
+    /* Updates the ratings with the outcome of a game.
+     * 'ranking' is the vector returned by run_game.
+     *
+     * Does nothing if load was not called.
+     */
+    void update( const std::vector<int>& ranking );
+
+    /* Atomically replaces the ratings file with the current ratings.
+     * Returns false if the file could not be written.
+     *
+     * Does nothing if load was not called.
+     */
+    bool save();
+
+    /* Returns a copy of every rating.
+     * Only copies the table; format does the slower work,
+     * so the copy can be taken while other threads wait.
+     *
+     * Returns an empty table if load was not called.
+     */
+    table snapshot();
+
+    /* Replaces every rating by those in the table
+     * (usually the result of an earlier call to snapshot).
+     *
+     * Must be called after load.
+     */
+    void restore( const table& );
+
+    /* Converts between a table and the format of the ratings file.
+     * parse returns false if the contents are malformed.
+     */
+    std::string format( const table& );
+    bool parse( const std::string& contents, table& );
+
+    /* Prints the ratings of the players of this game.
+     *
+     * Does nothing if load was not called.
+     */
+    void report( std::ostream& );
+
+}}} // namespace core::detail::rating
+
+#endif // CORE_DETAIL_RATING_H
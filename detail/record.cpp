@@ -0,0 +1,274 @@
+// Implementation of core/detail/record.h.
+#include <cstdio>
+#include <string>
+#include "record.h"
+#include "core/detail/variables.h"
+
+namespace core { namespace detail { namespace record {
+
+namespace {
+    /* Accumulates text and hands it to the FILE in large blocks.
+     * There is no flush per line.
+     * Write errors are remembered and reported by close.
+     */
+    class buffered_writer {
+        std::FILE * file = nullptr;
+        std::string buffer;
+        bool failed = false;
+
+        static const std::size_t capacity = 1 << 16;
+
+    public:
+        bool open( const char * path ) {
+            file = path ? std::fopen( path, "w" ) : stdout;
+            buffer.reserve( capacity );
+            failed = false;
+            return file != nullptr;
+        }
+
+        void put( char c ) {
+            buffer.push_back( c );
+        }
+
+        void put( const char * str ) {
+            buffer.append( str );
+        }
+
+        void put( const std::string& str ) {
+            buffer.append( str );
+        }
+
+        void put( long long value ) {
+            char digits[24];
+            int size = 0;
+            unsigned long long magnitude = value < 0 ? -(unsigned long long) value : value;
+            do {
+                digits[size++] = '0' + magnitude % 10;
+                magnitude /= 10;
+            } while( magnitude != 0 );
+            if( value < 0 )
+                buffer.push_back( '-' );
+            while( size > 0 )
+                buffer.push_back( digits[--size] );
+        }
+
+        /* Call after each complete record. */
+        void end_record() {
+            buffer.push_back( '\n' );
+            if( buffer.size() >= capacity )
+                flush();
+        }
+
+        void flush() {
+            if( std::fwrite( buffer.data(), 1, buffer.size(), file ) != buffer.size() )
+                failed = true;
+            buffer.clear();
+        }
+
+        /* Returns false if anything could not be written. */
+        bool close() {
+            flush();
+            if( file != stdout ) {
+                if( std::fclose( file ) != 0 )
+                    failed = true;
+            }
+            else if( std::fflush( file ) != 0 )
+                failed = true;
+            file = nullptr;
+            return !failed;
+        }
+    };
+
+    buffered_writer writer;
+    format current_format = HUMAN;
+
+    // Data for the summary.
+    long long games = 0;
+    long long rounds = 0;
+    long long truncated_games = 0;
+    std::vector<long long> first, second, third;
+    std::vector<long long> total_invalid_hands, total_invalid_guesses;
+
+    /* Writes a player name, quoted as needed by the current format. */
+    void put_name( const std::string& name ) {
+        if( current_format == CSV ) {
+            if( name.find_first_of( ",\"\n" ) == std::string::npos ) {
+                writer.put( name );
+                return;
+            }
+            writer.put( '"' );
+            for( char c : name ) {
+                if( c == '"' )
+                    writer.put( '"' );
+                writer.put( c );
+            }
+            writer.put( '"' );
+            return;
+        }
+
+        writer.put( '"' );
+        for( char c : name ) {
+            if( c == '"' || c == '\\' ) {
+                writer.put( '\\' );
+                writer.put( c );
+            }
+            else if( (unsigned char) c < 0x20 ) {
+                const char hex[] = "0123456789abcdef";
+                writer.put( "\\u00" );
+                writer.put( hex[c >> 4] );
+                writer.put( hex[c & 0xf] );
+            }
+            else
+                writer.put( c );
+        }
+        writer.put( '"' );
+    }
+
+    template< typename T >
+    void put_json_array( const char * key, const std::vector<T>& values ) {
+        writer.put( ",\"" );
+        writer.put( key );
+        writer.put( "\":[" );
+        for( unsigned i = 0; i < values.size(); i++ ) {
+            if( i != 0 ) writer.put( ',' );
+            writer.put( (long long) values[i] );
+        }
+        writer.put( ']' );
+    }
+
+    void put_json_seating() {
+        writer.put( ",\"seating\":[" );
+        for( unsigned i = 0; i < players.size(); i++ ) {
+            if( i != 0 ) writer.put( ',' );
+            put_name( players[i]->name() );
+        }
+        writer.put( ']' );
+    }
+} // anonymous namespace
+
+bool open( format f, const char * path ) {
+    current_format = f;
+    if( f == HUMAN )
+        return true;
+
+    games = rounds = truncated_games = 0;
+    first.assign( players.size(), 0 );
+    second.assign( players.size(), 0 );
+    third.assign( players.size(), 0 );
+    total_invalid_hands.assign( players.size(), 0 );
+    total_invalid_guesses.assign( players.size(), 0 );
+
+    if( !writer.open( path ) )
+        return false;
+
+    if( f == CSV ) {
+        writer.put( "record,game,seat,player,rank,rounds,"
+            "invalid_hands,invalid_guesses,truncated,first,second,third" );
+        writer.end_record();
+    }
+    return true;
+}
+
+void write_game( int game, const std::vector<int>& ranking ) {
+    if( current_format == HUMAN )
+        return;
+
+    games++;
+    rounds += round_count;
+    truncated_games += truncated;
+    first[ranking[0]]++;
+    second[ranking[1]]++;
+    if( ranking.size() >= 3 )
+        third[ranking[2]]++;
+    for( unsigned i = 0; i < players.size(); i++ ) {
+        total_invalid_hands[i] += invalid_hands[i];
+        total_invalid_guesses[i] += invalid_guesses[i];
+    }
+
+    if( current_format == CSV ) {
+        for( unsigned rank = 0; rank < ranking.size(); rank++ ) {
+            int seat = ranking[rank];
+            writer.put( "game," );
+            writer.put( (long long) game );
+            writer.put( ',' );
+            writer.put( (long long) seat );
+            writer.put( ',' );
+            put_name( players[seat]->name() );
+            writer.put( ',' );
+            writer.put( (long long) rank );
+            writer.put( ',' );
+            writer.put( (long long) round_count );
+            writer.put( ',' );
+            writer.put( (long long) invalid_hands[seat] );
+            writer.put( ',' );
+            writer.put( (long long) invalid_guesses[seat] );
+            writer.put( truncated ? ",1,,," : ",0,,," );
+            writer.end_record();
+        }
+        return;
+    }
+
+    writer.put( "{\"game\":" );
+    writer.put( (long long) game );
+    writer.put( ",\"rounds\":" );
+    writer.put( (long long) round_count );
+    writer.put( truncated ? ",\"truncated\":true" : ",\"truncated\":false" );
+    put_json_seating();
+    put_json_array( "ranking", ranking );
+    put_json_array( "invalid_hands", invalid_hands );
+    put_json_array( "invalid_guesses", invalid_guesses );
+    writer.put( '}' );
+    writer.end_record();
+}
+
+bool close() {
+    if( current_format == HUMAN )
+        return true;
+
+    if( current_format == CSV ) {
+        for( unsigned seat = 0; seat < players.size(); seat++ ) {
+            writer.put( "summary," );
+            writer.put( games );
+            writer.put( ',' );
+            writer.put( (long long) seat );
+            writer.put( ',' );
+            put_name( players[seat]->name() );
+            writer.put( ",," );
+            writer.put( rounds );
+            writer.put( ',' );
+            writer.put( total_invalid_hands[seat] );
+            writer.put( ',' );
+            writer.put( total_invalid_guesses[seat] );
+            writer.put( ',' );
+            writer.put( truncated_games );
+            writer.put( ',' );
+            writer.put( first[seat] );
+            writer.put( ',' );
+            writer.put( second[seat] );
+            writer.put( ',' );
+            writer.put( third[seat] );
+            writer.end_record();
+        }
+    }
+    else {
+        writer.put( "{\"summary\":{\"games\":" );
+        writer.put( games );
+        writer.put( ",\"rounds\":" );
+        writer.put( rounds );
+        writer.put( ",\"truncated\":" );
+        writer.put( truncated_games );
+        put_json_seating();
+        put_json_array( "first", first );
+        put_json_array( "second", second );
+        put_json_array( "third", third );
+        put_json_array( "invalid_hands", total_invalid_hands );
+        put_json_array( "invalid_guesses", total_invalid_guesses );
+        writer.put( "}}" );
+        writer.end_record();
+    }
+
+    current_format = HUMAN;
+    return writer.close();
+}
+
+}}} // namespace core::detail::record
@@ -0,0 +1,72 @@
+#ifndef CORE_DETAIL_RECORD_H
+#define CORE_DETAIL_RECORD_H
+
+/* Machine-readable output of the game results.
+ *
+ * Each game produces one record with the seating, the ranking,
+ * the number of rounds played and the invalid moves of each player;
+ * after the last game, a summary of all games is written.
+ *
+ * The records are formatted by hand into a large buffer,
+ * which is handed to the underlying FILE only when full,
+ * so writing millions of records costs little more than the formatting.
+ *
+ * The file formats are
+ *
+ *  csv: one row per seat per game, with the header
+ *      record,game,seat,player,rank,rounds,invalid_hands,invalid_guesses,truncated,first,second,third
+ *  Game rows have record = "game", truncated = 0 or 1,
+ *  and leave first, second and third empty.
+ *  Summary rows have record = "summary", game = number of games,
+ *  rounds, invalid_* and truncated summed over all games, and rank empty.
+ *
+ *  jsonl: one object per game, of the form
+ *      {"game":0,"rounds":7,"truncated":false,"seating":["a","b"],
+ *       "ranking":[1,0],"invalid_hands":[0,0],"invalid_guesses":[0,2]}
+ *  followed by a single object {"summary":{...}} with the fields
+ *  games, rounds, truncated (number of games), seating,
+ *  first, second, third, invalid_hands and invalid_guesses.
+ *
+ * Rank 0 is the winner of the game, the first player to empty its hand.
+ */
+#include <vector>
+
+namespace core { namespace detail { namespace record {
+
+    enum format {
+        HUMAN, // No records; the ranking is written to std::cout as text.
+        CSV,
+        JSONL,
+    };
+
+    /* Starts writing records in the given format.
+     * If 'path' is null, the records are written to the standard output.
+     *
+     * Returns false if the file could not be opened.
+     */
+    bool open( format, const char * path );
+
+    /* Writes the record of the game that has just ended.
+     * 'ranking' is the vector returned by run_game.
+     *
+     * Variables assumed valid:
+     *  players
+     *  round_count
+     *  invalid_hands
+     *  invalid_guesses
+     *  truncated
+     */
+    void write_game( int game, const std::vector<int>& ranking );
+
+    /* Writes the summary of every game passed to write_game,
+     * flushes the buffer and closes the file.
+     * Returns false if any record could not be written.
+     *
+     * Variables assumed valid:
+     *  players
+     */
+    bool close();
+
+}}} // namespace core::detail::record
+
+#endif // CORE_DETAIL_RECORD_H
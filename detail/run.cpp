@@ -1,25 +1,39 @@
 // Implementation of core/detail/run.h.
+#include <algorithm>
 #include <iostream>
 #include "run.h"
+#include "core/detail/dataset.h"
+#include "core/detail/metrics.h"
+#include "core/detail/profile.h"
 #include "core/detail/variables.h"
 #include "core/util.h" // constants PENDING_GUESS, NOT_PLAYING, INVALID_GUESS
 
 namespace core { namespace detail {
 
-std::vector<std::unique_ptr<Player>> players;
-std::map< Player *, int > position;
-std::vector<int> chopsticks;
-std::vector<int> last_hand;
-std::vector<int> current_hand;
-std::vector<int> guesses;
-std::vector<int> guess_template;
-int chopstick_count;
-int active_player_count;
-int last_winner;
-int starting_player;
-int hand_sum;
-std::vector<int> out_of_game;
-std::ostream * os = &std::cout;
+thread_local std::vector<std::unique_ptr<Player>> players;
+thread_local std::map< Player *, int > position;
+thread_local std::vector<int> chopsticks;
+thread_local std::vector<int> last_hand;
+thread_local std::vector<int> current_hand;
+thread_local std::vector<int> guesses;
+thread_local std::vector<int> guess_template;
+thread_local RoundContext round_context;
+thread_local int chopstick_count;
+thread_local int active_player_count;
+thread_local int last_winner;
+thread_local int starting_player;
+thread_local int hand_sum;
+thread_local std::vector<int> out_of_game;
+thread_local int round_count;
+thread_local std::vector<int> invalid_hands;
+thread_local std::vector<int> invalid_guesses;
+int max_rounds = 10000;
+int stall_limit = 10;
+thread_local std::unordered_map< std::uint64_t, int > recent_rounds;
+thread_local bool truncated;
+void (* round_hook)() = nullptr;
+std::unique_ptr<player_pool> player_sets;
+thread_local std::ostream * os = &std::cout;
 
 void out( std::ostream& new_os ) {
     os = &new_os;
@@ -29,32 +43,58 @@ std::ostream & out() {
     return *os;
 }
 
-void set_players( std::vector<std::pair<PlayerFactory, cmdline::args>>&& list ) {
-    players = std::vector<std::unique_ptr<Player>>( list.size() );
+void set_limits( int new_max_rounds, int new_stall_limit ) {
+    max_rounds = new_max_rounds;
+    stall_limit = new_stall_limit;
+}
 
-    for( unsigned i = 0; i < list.size(); i++ )
-        players[i].reset(list[i].first( std::move(list[i].second) ));
+void set_players( std::vector<std::pair<PlayerFactory, cmdline::args>>&& list ) {
+    player_sets.reset( new player_pool( std::move(list) ) );
+    players = player_sets->acquire();
 }
 
 void init( int initial_chopsticks ) {
+    init( initial_state( players.size(), initial_chopsticks ) );
+}
+
+void init( const game_state& start ) {
     for( unsigned i = 0; i < players.size(); i++ )
         position[players[i].get()] = i;
 
-    chopsticks.resize( players.size() );
-    std::fill( chopsticks.begin(), chopsticks.end(), initial_chopsticks );
+    chopsticks = start.chopsticks;
 
     current_hand = std::vector< int >( players.size(), -1 );
-    last_hand = current_hand;
+    last_hand = start.last_hand;
 
     guesses.resize( players.size() );
     guess_template = std::vector< int >( players.size(), PENDING_GUESS );
 
-    chopstick_count = initial_chopsticks * players.size();
-    active_player_count = players.size();
-    starting_player = 0;
-    last_winner = -1;
-
+    chopstick_count = 0;
+    active_player_count = 0;
     out_of_game.clear();
+    for( unsigned i = 0; i < players.size(); i++ ) {
+        chopstick_count += chopsticks[i];
+        if( chopsticks[i] != 0 ) {
+            active_player_count++;
+            continue;
+        }
+        guess_template[i] = NOT_PLAYING;
+        if( (int) i != start.last_winner )
+            out_of_game.push_back( i );
+    }
+    // The last winner, if it has just left, was the last to leave.
+    if( start.last_winner != -1 && chopsticks[start.last_winner] == 0 )
+        out_of_game.push_back( start.last_winner );
+
+    starting_player = start.starting_player;
+    last_winner = start.last_winner;
+
+    round_count = 0;
+    invalid_hands.assign( players.size(), 0 );
+    invalid_guesses.assign( players.size(), 0 );
+
+    recent_rounds.clear();
+    truncated = false;
 }
 
 int get_hand( const int index ) {
@@ -65,6 +105,7 @@ int get_hand( const int index ) {
             << hand << " chopsticks as its hand, "
             << "despite having only " << chopsticks[index] << " left.\n"
             << "Resetting its hand to 0...\n";
+        invalid_hands[index]++;
         return 0;
     }
 
@@ -79,6 +120,7 @@ int get_guess( const int index ) {
             << guess << ".\n"
             << "I will reset it to a negative value "
             << "to indicate an invalid guess.\n";
+        invalid_guesses[index]++;
         return INVALID_GUESS;
     }
     if( guess > chopstick_count ) {
@@ -88,18 +130,20 @@ int get_guess( const int index ) {
             << chopstick_count << " chopsticks left on the table.\n"
             << "I will reset it to a negative value "
             << "to indicate an invalid guess.\n";
+        invalid_guesses[index]++;
+        return INVALID_GUESS;
+    }
+    int j = round_context.guessed_by[guess];
+    if( j != -1 ) {
+        std::clog << "Player " << players[index]->name()
+            << ", at position " << index << ", guessed the value "
+            << guess << " - thats the same value that player "
+            << players[j]->name() << " guessed.\n"
+            << "I will reset it to a negative value "
+            << "to indicate an invalid guess.\n";
+        invalid_guesses[index]++;
         return INVALID_GUESS;
     }
-    for( int j = 0; j < players.size(); ++j )
-        if( j != index && guess == guesses[j] ) {
-            std::clog << "Player " << players[index]->name()
-                << ", at position " << index << ", guessed the value "
-                << guess << " - thats the same value that player "
-                << players[j]->name() << " guessed.\n"
-                << "I will reset it to a negative value "
-                << "to indicate an invalid guess.\n";
-            return INVALID_GUESS;
-        }
 
     return guess;
 }
@@ -117,7 +161,10 @@ void contabilize_round_winner() {
 
     // Contabilizing the winner
     if( last_winner == -1 ) {
-        out() << "No one guessed the right value (" << hand_sum << ").\n";
+        {
+            profile::scope scope( profile::OUTPUT_FORMATTING );
+            out() << "No one guessed the right value (" << hand_sum << ").\n";
+        }
 
         do {
             starting_player = (starting_player + 1) % players.size();
@@ -126,9 +173,12 @@ void contabilize_round_winner() {
         return;
     }
 
-    out() << "Player " << last_winner
-        << " (" << players[last_winner]->name() << ")"
-        << " guessed right!\n";
+    {
+        profile::scope scope( profile::OUTPUT_FORMATTING );
+        out() << "Player " << last_winner
+            << " (" << players[last_winner]->name() << ")"
+            << " guessed right!\n";
+    }
 
     chopstick_count--;
     starting_player = last_winner;
@@ -137,9 +187,12 @@ void contabilize_round_winner() {
     if( chopsticks[last_winner] != 0 )
         return;
 
-    out() << "Player " << last_winner
-        << " (" << players[last_winner]->name() << ")"
-        << " left the game.\n";
+    {
+        profile::scope scope( profile::OUTPUT_FORMATTING );
+        out() << "Player " << last_winner
+            << " (" << players[last_winner]->name() << ")"
+            << " left the game.\n";
+    }
 
     out_of_game.push_back( last_winner );
 
@@ -152,47 +205,126 @@ void contabilize_round_winner() {
 
 void run_round() {
     guesses = guess_template;
+    round_count++;
+
+    round_context.chopstick_count = chopstick_count;
+    round_context.pending_guesses = active_player_count;
+    round_context.free_guess_count = chopstick_count + 1;
+    round_context.guessed_by.assign( chopstick_count + 1, -1 );
 
-    out() << chopstick_count << " chopsticks on the table...\n";
+    {
+        profile::scope scope( profile::OUTPUT_FORMATTING );
+        out() << chopstick_count << " chopsticks on the table...\n";
+    }
 
     // Pick each player hand
     hand_sum = 0;
-    for( int i = 0; i < players.size(); ++i ) {
-        int p = (i + starting_player) % players.size();
-        if( guesses[p] == NOT_PLAYING ) continue;
-        current_hand[p] = get_hand(p);
-        hand_sum += current_hand[p];
+    {
+        profile::scope scope( profile::HAND_COLLECTION );
+        for( int i = 0; i < players.size(); ++i ) {
+            int p = (i + starting_player) % players.size();
+            if( guesses[p] == NOT_PLAYING ) {
+                current_hand[p] = -1;
+                continue;
+            }
+            current_hand[p] = get_hand(p);
+            hand_sum += current_hand[p];
+            if( dataset::active )
+                dataset::record( dataset::HAND, p, current_hand[p] );
+        }
     }
 
     // Pick each player guess
     last_winner = -1;
-    for( int i = 0; i < players.size(); ++i ) {
-        int p = (i + starting_player) % players.size();
-        if( guesses[p] == NOT_PLAYING ) continue;
-        guesses[p] = get_guess(p);
-
-        /* Its easier to do the last_winner test now
-         * than to loop through the vector again.
-         * No one will know... */
-        if( guesses[p] == hand_sum )
-            last_winner = p;
+    {
+        profile::scope scope( profile::GUESS_COLLECTION );
+        for( int i = 0; i < players.size(); ++i ) {
+            int p = (i + starting_player) % players.size();
+            if( guesses[p] == NOT_PLAYING ) continue;
+            int guess = get_guess(p);
+            if( dataset::active )
+                dataset::record( dataset::GUESS, p, guess );
+            guesses[p] = guess;
+
+            round_context.pending_guesses--;
+            if( guess >= 0 ) {
+                round_context.guessed_by[guess] = p;
+                round_context.free_guess_count--;
+            }
+
+            /* Its easier to do the last_winner test now
+             * than to loop through the vector again.
+             * No one will know... */
+            if( guesses[p] == hand_sum )
+                last_winner = p;
+        }
     }
 
-    contabilize_round_winner();
+    {
+        profile::scope scope( profile::WINNER_ACCOUNTING );
+        contabilize_round_winner();
+    }
 
 
     // Calling Player::end_round() for each player
     for( int i = 0; i < players.size(); ++i ) {
         int p = (i + starting_player) % players.size();
         if( guesses[p] == NOT_PLAYING ) continue;
-        players[p]->end_round();
+        {
+            profile::scope scope( profile::END_ROUND_CALLBACKS );
+            players[p]->end_round();
+        }
+        profile::scope scope( profile::OUTPUT_FORMATTING );
         out() << "Player " << p << " (" << players[p]->name() << ")"
             << " - hand: " << last_hand[p] << " - guess: " << guesses[p] << '\n';
     }
 }
 
+bool stalled() {
+    if( stall_limit == 0 )
+        return false;
+
+    if( last_winner != -1 ) {
+        recent_rounds.clear();
+        return false;
+    }
+
+    // FNV-1a over the round
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash]( int value ) {
+        hash ^= (std::uint32_t) value;
+        hash *= 1099511628211ull;
+    };
+    mix( starting_player );
+    for( unsigned i = 0; i < players.size(); i++ ) {
+        mix( last_hand[i] );
+        mix( guesses[i] );
+    }
+
+    return ++recent_rounds[hash] >= stall_limit;
+}
+
+void rank_remaining_players() {
+    std::vector<int> remaining;
+    for( unsigned i = 0; i < players.size(); i++ ) {
+        int p = (i + starting_player) % players.size();
+        if( guess_template[p] != NOT_PLAYING )
+            remaining.push_back( p );
+    }
+
+    std::stable_sort( remaining.begin(), remaining.end(),
+        []( int a, int b ) { return chopsticks[a] < chopsticks[b]; }
+    );
+
+    out_of_game.insert( out_of_game.end(), remaining.begin(), remaining.end() );
+}
+
 std::vector<int> run_game( int initial_chopsticks ) {
-    init( initial_chopsticks );
+    return run_game( initial_state( players.size(), initial_chopsticks ) );
+}
+
+std::vector<int> run_game( const game_state& start ) {
+    init( start );
 
     for( int i = 0; i < players.size(); ++i )
         players[i]->begin_game();
@@ -200,22 +332,49 @@ std::vector<int> run_game( int initial_chopsticks ) {
     const char * next_round_msg = "";
 
     while( active_player_count >= 2 ) {
-        out() << next_round_msg;
+        if( round_count == max_rounds || stalled() ) {
+            truncated = true;
+            break;
+        }
+
+        if( round_hook )
+            round_hook();
+
+        {
+            profile::scope scope( profile::OUTPUT_FORMATTING );
+            out() << next_round_msg;
+        }
         next_round_msg = "Next round...\n\n";
 
         run_round();
     }
 
     for( int i = 0; i < players.size(); ++i )
-        players[i]->begin_game();
+        players[i]->end_game();
 
-    out() << "Game ended. \n"
-        << "Loser: player " << starting_player
-        << " (" << players[starting_player]->name() << ")"
-        << ", with " << chopsticks[starting_player] << " choptsticks.\n";
+    if( truncated ) {
+        rank_remaining_players();
 
-    out_of_game.push_back(starting_player);
+        profile::scope scope( profile::OUTPUT_FORMATTING );
+        out() << "Game truncated after " << round_count << " rounds.\n"
+            << "Loser: player " << out_of_game.back()
+            << " (" << players[out_of_game.back()]->name() << ")"
+            << ", with " << chopsticks[out_of_game.back()] << " choptsticks.\n";
+    }
+    else {
+        {
+            profile::scope scope( profile::OUTPUT_FORMATTING );
+            out() << "Game ended. \n"
+                << "Loser: player " << starting_player
+                << " (" << players[starting_player]->name() << ")"
+                << ", with " << chopsticks[starting_player] << " choptsticks.\n";
+        }
+
+        out_of_game.push_back(starting_player);
+    }
 
+    dataset::end_game( out_of_game );
+    metrics::end_game( out_of_game );
     return out_of_game;
 }
 
@@ -12,6 +12,7 @@
  */
 #include <ostream>
 #include "player.h"
+#include "core/detail/state.h"
 
 namespace core { namespace detail {
     /* Sets the players for this game.
@@ -19,12 +20,15 @@ namespace core { namespace detail {
      *
      * Each argument in the list is a pair<factory, args>.
      * Each factory will be called with the arguments it is paired with.
+     * The list is kept in player_sets,
+     * so other threads can construct their own set of players.
      *
      * This function guarantees that the variable 'players'
      * will have its final size before calling any factory function.
      *
      * Updated variables:
      *  players
+     *  player_sets
      */
     void set_players( std::vector<std::pair<PlayerFactory, cmdline::args>>&& );
 
@@ -35,6 +39,23 @@ namespace core { namespace detail {
     void out( std::ostream& );
     std::ostream & out();
 
+    /* Sets the limits that stop games that would not end by themselves.
+     *
+     * 'max_rounds' is the maximum number of rounds of a game.
+     * 'stall_limit' is how many times the same round
+     * (same starting player, hands and guesses)
+     * may happen with no right guess in between
+     * before the game is considered stalled.
+     * Zero disables the respective limit.
+     *
+     * Defaults to 10000 rounds and 10 repetitions.
+     *
+     * Updated variables:
+     *  max_rounds
+     *  stall_limit
+     */
+    void set_limits( int max_rounds, int stall_limit );
+
     /* Run a game with the specified number of chopsticks.
      *
      * This function assumse that set_players had already been called.
@@ -44,11 +65,28 @@ namespace core { namespace detail {
      *
      * Returns the ranking of each player.
      *
+     * If the game exceeds max_rounds or stalls,
+     * it is truncated and the players still in the game are ranked
+     * by their number of chopsticks, fewest first;
+     * ties are broken in playing order, beginning at starting_player.
+     * The variable 'truncated' tells whether this happened.
+     *
      * Variables assumed valid:
      *  players
      */
     std::vector<int> run_game( int choptsicks );
 
+    /* Run a game from the given position,
+     * which is assumed to be valid (see 'validate').
+     *
+     * The players that are already out of the game
+     * emptied their hands before everyone else,
+     * so they are ranked first, in seat order;
+     * except for the last winner, which, if it has just left the game,
+     * is ranked right after them.
+     */
+    std::vector<int> run_game( const game_state& );
+
     /* Initialize the variables of the game.
      *
      * Variables assumed valid:
@@ -66,11 +104,25 @@ namespace core { namespace detail {
      *  starting_player
      *  last_winner
      *  out_of_game
-     *
-     * Essentially, all variables except players and hand_sum.
+     *  round_count
+     *  invalid_hands
+     *  invalid_guesses
+     *  recent_rounds
+     *  truncated
+     *
+     * Essentially, all variables except players, hand_sum,
+     * max_rounds and stall_limit.
      */
     void init( int initial_chopsticks );
 
+    /* Initialize the variables of the game from a position
+     * other than the opening.
+     *
+     * Variables assumed valid and updated variables
+     * are the same as for init(int).
+     */
+    void init( const game_state& );
+
     /* Calls player[index]->hand() and apply sanity checks.
      * Returns zero if the player did not return a valid value;
      * otherwise, return the correct player hand
@@ -82,6 +134,7 @@ namespace core { namespace detail {
      *
      * Updated variables:
      *  players (calls non-const method on one of them).
+     *  invalid_hands
      */
     int get_hand( int index );
 
@@ -95,9 +148,11 @@ namespace core { namespace detail {
      * Variables assumed valid:
      *  players
      *  chopstick_count
+     *  round_context
      *
      * Updated variables:
      *  players (calls non-const method on one of them).
+     *  invalid_guesses
      */
     int get_guess( int index );
 
@@ -133,13 +188,46 @@ namespace core { namespace detail {
      *  last_hand
      *  guesses
      *  guess_template
+     *  round_context
      *  chopstick_count
      *  active_player_count
      *  starting_player
      *  last_winner
      *  out_of_game
+     *  round_count
+     *  invalid_hands
+     *  invalid_guesses
      */
     void run_round();
+
+    /* Decides, after a round, whether the game is stalled.
+     *
+     * Variables assumed valid:
+     *  players
+     *  last_hand
+     *  guesses
+     *  starting_player
+     *  last_winner
+     *  stall_limit
+     *
+     * Updated variables:
+     *  recent_rounds
+     */
+    bool stalled();
+
+    /* Appends the players still in the game to out_of_game,
+     * in the tie-break order of truncated games.
+     *
+     * Variables assumed valid:
+     *  players
+     *  chopsticks
+     *  guess_template
+     *  starting_player
+     *
+     * Updated variables:
+     *  out_of_game
+     */
+    void rank_remaining_players();
 }} // namespace core::detail
 
 #endif // CORE_DETAIL_RUN_H
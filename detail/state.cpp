@@ -0,0 +1,175 @@
+// Implementation of core/detail/state.h.
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "state.h"
+#include "core/detail/run.h"
+#include "core/detail/variables.h"
+
+namespace core { namespace detail {
+
+game_state initial_state( int player_count, int initial_chopsticks ) {
+    game_state p;
+    p.chopsticks = std::vector<int>( player_count, initial_chopsticks );
+    p.starting_player = 0;
+    p.last_hand = std::vector<int>( player_count, -1 );
+    p.last_winner = -1;
+    return p;
+}
+
+game_state current_state() {
+    game_state p;
+    p.chopsticks = chopsticks;
+    p.starting_player = starting_player;
+    p.last_hand = last_hand;
+    p.last_winner = last_winner;
+    return p;
+}
+
+const char * validate( const game_state& p, int player_count ) {
+    if( (int) p.chopsticks.size() != player_count || (int) p.last_hand.size() != player_count )
+        return "the position is for a different number of players";
+
+    int active = 0;
+    for( int c : p.chopsticks ) {
+        if( c < 0 )
+            return "negative number of chopsticks";
+        if( c > 0 )
+            active++;
+    }
+    if( active < 2 )
+        return "less than two players still in the game";
+
+    if( p.starting_player < 0 || p.starting_player >= player_count )
+        return "starting player out of range";
+    if( p.chopsticks[p.starting_player] == 0 )
+        return "starting player is out of the game";
+
+    if( p.last_winner < -1 || p.last_winner >= player_count )
+        return "last winner out of range";
+    /* The winner of a round starts the next one,
+     * unless it has just left the game.
+     */
+    if( p.last_winner != -1 && p.last_winner != p.starting_player
+            && p.chopsticks[p.last_winner] != 0 )
+        return "last winner is still in the game but is not the starting player";
+
+    for( int i = 0; i < player_count; i++ ) {
+        // The last winner had one chopstick more when it chose its hand.
+        int had = p.chopsticks[i] + (i == p.last_winner ? 1 : 0);
+        if( p.last_hand[i] < -1 || p.last_hand[i] > had )
+            return "last hand larger than the chopsticks the player had";
+    }
+
+    return nullptr;
+}
+
+bool parse_state( const std::string& line, int player_count, game_state& p ) {
+    std::istringstream fields( line );
+    p.chopsticks.resize( player_count );
+    p.last_hand.resize( player_count );
+    fields >> p.starting_player >> p.last_winner;
+    for( auto & c : p.chopsticks )
+        fields >> c;
+    for( auto & h : p.last_hand )
+        fields >> h;
+
+    std::string extra;
+    return fields && !(fields >> extra);
+}
+
+void write_state( std::ostream& out, const game_state& p ) {
+    out << p.starting_player << ' ' << p.last_winner;
+    for( int c : p.chopsticks )
+        out << ' ' << c;
+    for( int h : p.last_hand )
+        out << ' ' << h;
+    out << '\n';
+}
+
+bool load_states( const char * path, int player_count,
+        std::vector<game_state>& out, std::string& error )
+{
+    std::ifstream in( path );
+    if( !in ) {
+        error = std::string("could not open ") + path;
+        return false;
+    }
+
+    std::string line;
+    for( int line_number = 1; std::getline(in, line); line_number++ ) {
+        if( line.empty() )
+            continue;
+
+        game_state p;
+        if( !parse_state( line, player_count, p ) ) {
+            std::ostringstream message;
+            message << path << ":" << line_number << ": expected "
+                << 2 + 2 * player_count << " integers";
+            error = message.str();
+            return false;
+        }
+        out.push_back( std::move(p) );
+    }
+    return true;
+}
+
+bool save_states( const char * path, const std::vector<game_state>& positions ) {
+    std::ofstream out( path );
+    for( const auto & p : positions )
+        write_state( out, p );
+    return bool(out);
+}
+
+namespace {
+    // State of sample_states, reached from the round hook.
+    std::vector<game_state> * sample;
+    unsigned sample_size;
+    int sample_max_chopsticks;
+    long long candidates;
+    std::mt19937_64 rng;
+
+    void sample_round() {
+        if( chopstick_count > sample_max_chopsticks )
+            return;
+
+        // Reservoir sampling
+        if( sample->size() < sample_size )
+            sample->push_back( current_state() );
+        else {
+            long long j = std::uniform_int_distribution<long long>( 0, candidates )( rng );
+            if( j < sample_size )
+                (*sample)[j] = current_state();
+        }
+        candidates++;
+    }
+} // anonymous namespace
+
+std::vector<game_state> sample_states( int count,
+        int initial_chopsticks, int max_chopstick_count, std::uint64_t seed )
+{
+    std::vector<game_state> positions;
+    sample = &positions;
+    sample_size = count;
+    sample_max_chopsticks = max_chopstick_count;
+    candidates = 0;
+    rng.seed( seed );
+
+    std::ostream null_os(0);
+    std::ostream & old_os = out();
+    out( null_os );
+    round_hook = sample_round;
+
+    /* The game count bound stops the simulation
+     * when too few rounds are below max_chopstick_count.
+     */
+    long long max_games = 1000 + 100ll * count;
+    for( long long game = 0; game < max_games && candidates < 4ll * count; game++ )
+        run_game( initial_state( players.size(), initial_chopsticks ) );
+
+    round_hook = nullptr;
+    out( old_os );
+    return positions;
+}
+
+}} // namespace core::detail
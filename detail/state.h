@@ -0,0 +1,98 @@
+#ifndef CORE_DETAIL_STATE_H
+#define CORE_DETAIL_STATE_H
+
+/* Game positions: the state of the table at the beginning of a round.
+ *
+ * Games may start from any valid position, not only from the opening,
+ * so benchmarks can spend their time in the endgames,
+ * where the players actually differ.
+ *
+ * Positions are stored in text files, one per line, as
+ *      <starting_player> <last_winner> <chopsticks_0> ... <chopsticks_n-1> <hand_0> ... <hand_n-1>
+ * where n is the number of players and hand_i is last round's hand.
+ */
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace core { namespace detail {
+
+    struct game_state {
+        /* Number of chopsticks of each player.
+         * Players with no chopsticks are out of the game.
+         */
+        std::vector<int> chopsticks;
+
+        /* Player that starts guessing. */
+        int starting_player;
+
+        /* Hand of each player in the previous round;
+         * -1 if unknown or if the player did not play.
+         */
+        std::vector<int> last_hand;
+
+        /* Winner of the previous round, or -1. */
+        int last_winner;
+    };
+
+    /* Opening position: every player with the same number of chopsticks,
+     * player 0 starting and no previous round.
+     */
+    game_state initial_state( int player_count, int initial_chopsticks );
+
+    /* Returns the position at the beginning of the next round.
+     *
+     * Variables assumed valid:
+     *  chopsticks
+     *  starting_player
+     *  last_hand
+     *  last_winner
+     */
+    game_state current_state();
+
+    /* Checks the position against the rules of the game
+     * for a table with 'player_count' players.
+     * Returns a description of the first problem found,
+     * or null if the position is valid.
+     */
+    const char * validate( const game_state&, int player_count );
+
+    /* Reads a position from a line in the format above.
+     * Returns false if the line is malformed.
+     * The position is not validated.
+     */
+    bool parse_state( const std::string& line, int player_count, game_state& );
+
+    /* Writes the position as a line in the format above. */
+    void write_state( std::ostream&, const game_state& );
+
+    /* Reads every position of the file.
+     * Returns false if the file cannot be read, or if any line is malformed;
+     * 'error' then describes the problem.
+     * The positions are not validated.
+     */
+    bool load_states( const char * path, int player_count,
+            std::vector<game_state>& out, std::string& error );
+
+    /* Writes the positions to the file.
+     * Returns false if the file could not be written.
+     */
+    bool save_states( const char * path, const std::vector<game_state>& );
+
+    /* Samples 'count' positions uniformly from the rounds of simulated games
+     * whose chopstick count is at most 'max_chopstick_count'.
+     * Games are simulated from the opening with 'initial_chopsticks',
+     * until four times 'count' candidate rounds are seen.
+     *
+     * The game output is suppressed during the simulation.
+     *
+     * Variables assumed valid:
+     *  players
+     */
+    std::vector<game_state> sample_states( int count,
+            int initial_chopsticks, int max_chopstick_count, std::uint64_t seed );
+
+}} // namespace core::detail
+
+#endif // CORE_DETAIL_STATE_H
@@ -2,45 +2,61 @@
 #define DETAIL_VARIABLES_H
 
 /* Global variables inside namespace core::detail.
+ *
+ * The state of the game is thread_local,
+ * so several threads may each run their own game,
+ * with their own set of players;
+ * the functions in core/util.h then answer for the calling thread's game.
+ * The settings (max_rounds, stall_limit, round_hook and player_sets)
+ * are shared by every thread and must not change while games are running.
  */
 
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <unordered_map>
 #include <ostream>
 #include <vector>
 #include "player.h"
+#include "core/util.h"
+#include "core/detail/pool.h"
 
 namespace core { namespace detail {
     /* Output stream used by the functions in this namespace.
      */
-    extern std::ostream * os;
+    extern thread_local std::ostream * os;
 
     /* List of players, indexed by their position.
      */
-    extern std::vector<std::unique_ptr<Player>> players;
+    extern thread_local std::vector<std::unique_ptr<Player>> players;
 
     /* Reverse map: it gives the player position
      * based on a pointer to it.
      */
-    extern std::map< Player *, int > position;
+    extern thread_local std::map< Player *, int > position;
 
     /* Number of chopsticks each player have avaliable. */
-    extern std::vector<int> chopsticks;
+    extern thread_local std::vector<int> chopsticks;
 
     /* Number of chopsticks each player holds in hand in this round.
      *
      * This vector is swapped with `last_hand` every round.
      */
-    extern std::vector<int> current_hand;
+    extern thread_local std::vector<int> current_hand;
 
     /* Number of chopsticks each player held in hand last round. */
-    extern std::vector<int> last_hand;
+    extern thread_local std::vector<int> last_hand;
 
     /* Guesses each player has made this round.
      * This is the vector `other_guesses` passed to the players
      * when invoking Player::guess.
      */
-    extern std::vector<int> guesses;
+    extern thread_local std::vector<int> guesses;
+
+    /* Derived facts about the current round;
+     * reset at the beginning of the round and updated after each guess.
+     */
+    extern thread_local RoundContext round_context;
 
     /* Initial empty guess vector for each round.
      *
@@ -50,23 +66,23 @@ namespace core { namespace detail {
      * It will start populated as PENDING_GUESS.
      * We will change it to NOT_PLAYING as the game progresses.
      */
-    extern std::vector<int> guess_template;
+    extern thread_local std::vector<int> guess_template;
 
     /* Sum of all avaliable chopsticks in the table. */
-    extern int chopstick_count;
+    extern thread_local int chopstick_count;
 
     /* Sum of the vector current_hand.
      * That is, the correct guess for this round.
      *
      * It is only updated after current_hand is populated.
      */
-    extern int hand_sum;
+    extern thread_local int hand_sum;
 
     /* Number players that are still playing the game. */
-    extern int active_player_count;
+    extern thread_local int active_player_count;
 
     /* Player that starts guessing this round. */
-    extern int starting_player;
+    extern thread_local int starting_player;
 
     /* Player that won last round.
      *
@@ -74,7 +90,7 @@ namespace core { namespace detail {
      * unless no one made the right guess last round.
      * In this case, last_winner == -1.
      */
-    extern int last_winner;
+    extern thread_local int last_winner;
 
     /* List that contains the list of players that are outside of the game
      * due to emptying their hands,
@@ -82,7 +98,47 @@ namespace core { namespace detail {
      *
      * At the end of the game, this will have the "ranking" of each player.
      */
-    extern std::vector<int> out_of_game;
+    extern thread_local std::vector<int> out_of_game;
+
+    /* Number of rounds played in this game so far. */
+    extern thread_local int round_count;
+
+    /* Number of invalid hands and invalid guesses
+     * each player has made in this game.
+     */
+    extern thread_local std::vector<int> invalid_hands;
+    extern thread_local std::vector<int> invalid_guesses;
+
+    /* Maximum number of rounds of a game; 0 means no limit. */
+    extern int max_rounds;
+
+    /* A game is considered stalled when the same round
+     * (same starting player, hands and guesses)
+     * happens this many times without anyone guessing right in between.
+     * 0 disables the stall detection.
+     */
+    extern int stall_limit;
+
+    /* How many times each round happened since the last right guess,
+     * indexed by a hash of the round.
+     */
+    extern thread_local std::unordered_map< std::uint64_t, int > recent_rounds;
+
+    /* Whether the game was stopped by max_rounds or stall_limit
+     * instead of ending normally.
+     */
+    extern thread_local bool truncated;
+
+    /* Called at the beginning of each round,
+     * before any player chooses its hand.
+     * Null by default.
+     */
+    extern void (* round_hook)();
+
+    /* Pool with every set of players constructed so far;
+     * set by set_players.
+     */
+    extern std::unique_ptr<player_pool> player_sets;
 
 }} // namespace core::detail
 
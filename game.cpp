@@ -28,9 +28,135 @@ namespace core { namespace command_line {
 "    Chose the number of games to be run.\n"
 "    Default value: 1\n"
 "\n"
+"--max-rounds <N>\n"
+"    Stop a game after this many rounds.\n"
+"    The players still in the game are ranked by their chopsticks, fewest first.\n"
+"    0 means no limit.\n"
+"    Default value: 10000.\n"
+"\n"
+"--stall-limit <N>\n"
+"    Stop a game, as with --max-rounds, when the same round\n"
+"    (same starting player, hands and guesses)\n"
+"    happens N times with no right guess in between.\n"
+"    0 disables this check.\n"
+"    Default value: 10.\n"
+"\n"
+"--positions <path>\n"
+"    Start the games from the positions stored in this file\n"
+"    instead of the opening, using each position in turn.\n"
+"    Each line holds the starting player, the last round's winner (or -1),\n"
+"    the chopsticks of each player and the last round's hand of each player\n"
+"    (or -1), separated by spaces.\n"
+"\n"
+"--sample-positions <N>\n"
+"    Simulate games among the chosen players and sample N positions\n"
+"    from their rounds to start the games from.\n"
+"    These are added to the positions of --positions, if any.\n"
+"\n"
+"--endgame <N>\n"
+"    Only sample positions with at most N chopsticks on the table.\n"
+"    0 means no restriction.\n"
+"    Default value: 0.\n"
+"\n"
+"--seed <N>\n"
+"    Seed of the position sampling.\n"
+"    Default value: 0.\n"
+"\n"
+"--save-positions <path>\n"
+"    Write the starting positions to this file, in the format of --positions.\n"
+"\n"
+"--threads <N>\n"
+"    Run the games in N threads, each with its own instance of every player.\n"
+"    The instances are constructed concurrently, once, and reused across games;\n"
+"    players must therefore be safe to construct and run in parallel.\n"
+"    The game output is disabled when N > 1.\n"
+"    Default value: 1.\n"
+"\n"
 "--disable-game-output\n"
 "    Disable the output of the game outcome every round.\n"
 "\n"
+"--output-format <format>\n"
+"    Chose how the results are written.\n"
+"    'human' prints the ranking as text;\n"
+"    'csv' and 'jsonl' write one record per game and a final summary.\n"
+"    Combine with --disable-game-output or --output-file\n"
+"    to keep the records apart from the game outcome.\n"
+"    Default value: human.\n"
+"\n"
+"--output-file <path>\n"
+"    Write the csv or jsonl records to this file\n"
+"    instead of the standard output.\n"
+"\n"
+"--ratings <path>\n"
+"    Update the rating of each player after every game,\n"
+"    starting from the ratings stored in this file,\n"
+"    and write the new ratings back to it at the end.\n"
+"    Players are identified by name; new players start at 1500.\n"
+"\n"
+"--rating-k <K>\n"
+"    Chose the K factor of the rating updates.\n"
+"    Default value: 16.\n"
+"\n"
+"--cache <path>\n"
+"    Store the final tally of several games in this file,\n"
+"    and read it back instead of playing when the same matchup\n"
+"    (same engine and player builds, core options, players\n"
+"    and player options) is run again.\n"
+"    Not used together with --ratings, --training-data or csv/jsonl output,\n"
+"    which need every game to be played.\n"
+"\n"
+"--build-id <string>\n"
+"    Identity of the engine used in the cache key.\n"
+"    By default, it is a hash of the executable file,\n"
+"    so any rebuild invalidates every cached matchup;\n"
+"    set it by hand to keep cached results across rebuilds\n"
+"    that do not change the engine.\n"
+"\n"
+"--player-build <name>=<string>\n"
+"    Identity of the build of the named player, used in the cache key\n"
+"    of every matchup that includes it. May be repeated.\n"
+"    With a fixed --build-id and one --player-build per player,\n"
+"    changing the string of a single player after modifying it\n"
+"    replays only the matchups in which that player takes part.\n"
+"\n"
+"--training-data <path>\n"
+"    Record every hand and guess of every player to this file,\n"
+"    with the state visible to the player and its final rank in the game.\n"
+"    See core/detail/dataset.h for the file format.\n"
+"\n"
+"--metrics <path>\n"
+"    Periodically write live counters of the run to this file\n"
+"    (games, rounds and games per second; invalid hands,\n"
+"    invalid guesses and wins of each player)\n"
+"    in the Prometheus text format.\n"
+"\n"
+"--metrics-interval <seconds>\n"
+"    Time between writes of the metrics file.\n"
+"    Default value: 5.\n"
+"\n"
+"--checkpoint <path>\n"
+"    Periodically save the state of a run of several games to this file\n"
+"    (games played, tally, starting positions and ratings).\n"
+"    The file is written in the background and replaced atomically.\n"
+"\n"
+"--checkpoint-interval <N>\n"
+"    Save a checkpoint every N games.\n"
+"    Default value: 100000.\n"
+"\n"
+"--resume\n"
+"    Continue the run saved in the --checkpoint file, if it exists.\n"
+"    The command line must be the same as that of the interrupted run.\n"
+"    Not available with csv/jsonl output or --training-data.\n"
+"\n"
+"--profile\n"
+"    Measure the time spent in each phase of the engine\n"
+"    (hand collection, guess collection, winner accounting,\n"
+"    end_round callbacks and output formatting).\n"
+"    On Linux, the hardware counters for cycles, instructions,\n"
+"    cache misses and branch misses are also read for each phase.\n"
+"    The results are shown after the ranking;\n"
+"    with csv or jsonl output, they go to stderr instead.\n"
+"\n"
 "--list\n"
 "    List avaliable players and quit.\n"
 "\n"
@@ -39,13 +165,24 @@ namespace core { namespace command_line {
 ;
 }} // namespace core::command_line
 
+#include <atomic>
+#include <climits>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <getopt.h>
 #include "game.h"
 #include "core/util.h"
+#include "core/detail/cache.h"
+#include "core/detail/checkpoint.h"
+#include "core/detail/dataset.h"
+#include "core/detail/metrics.h"
+#include "core/detail/profile.h"
+#include "core/detail/rating.h"
+#include "core/detail/record.h"
 #include "core/detail/run.h"
 #include "core/detail/variables.h"
 
@@ -64,6 +201,39 @@ namespace core {
 
         int chopsticks = 3;
         int games = 1;
+        int threads = 1;
+        int max_rounds = 10000;
+        int stall_limit = 10;
+        std::string positions_file;
+        int sample_positions = 0;
+        int endgame = 0;
+        unsigned long long seed = 0;
+        std::string save_positions_file;
+        bool profile = false;
+        detail::record::format output_format = detail::record::HUMAN;
+        std::string output_file;
+        std::string ratings_file;
+        double rating_k = 16.0;
+        std::string cache_file;
+        std::string build_id;
+
+        /* Identity of each player's build, by player name (--player-build). */
+        std::map< std::string, std::string > player_builds;
+
+        /* Name and command line options of each player,
+         * in the same order as player_list.
+         * Used to identify the matchup in the results cache.
+         */
+        std::vector< std::vector<std::string> > player_keys;
+
+        std::string training_data_file;
+
+        std::string metrics_file;
+        double metrics_interval = 5.0;
+
+        std::string checkpoint_file;
+        int checkpoint_interval = 100000;
+        bool resume = false;
         std::vector< std::pair<PlayerFactory, cmdline::args> > player_list;
 
         /* Returns true if str is of the format [string]. */
@@ -94,15 +264,122 @@ namespace core {
                     args >> games;
                     continue;
                 }
+                if( arg == "--threads" ) {
+                    args >> threads;
+                    continue;
+                }
+                if( arg == "--max-rounds" ) {
+                    args >> max_rounds;
+                    continue;
+                }
+                if( arg == "--stall-limit" ) {
+                    args >> stall_limit;
+                    continue;
+                }
+                if( arg == "--positions" ) {
+                    args >> positions_file;
+                    continue;
+                }
+                if( arg == "--sample-positions" ) {
+                    args >> sample_positions;
+                    continue;
+                }
+                if( arg == "--endgame" ) {
+                    args >> endgame;
+                    continue;
+                }
+                if( arg == "--seed" ) {
+                    args >> seed;
+                    continue;
+                }
+                if( arg == "--save-positions" ) {
+                    args >> save_positions_file;
+                    continue;
+                }
                 if( arg == "--disable-game-output" ) {
                     detail::out(null_os);
                     continue;
                 }
+                if( arg == "--output-format" ) {
+                    std::string format;
+                    args >> format;
+                    if( format == "human" )
+                        output_format = detail::record::HUMAN;
+                    else if( format == "csv" )
+                        output_format = detail::record::CSV;
+                    else if( format == "jsonl" )
+                        output_format = detail::record::JSONL;
+                    else {
+                        std::cerr << "Unknown output format '" << format << "'.\n";
+                        std::exit(1);
+                    }
+                    continue;
+                }
+                if( arg == "--output-file" ) {
+                    args >> output_file;
+                    continue;
+                }
+                if( arg == "--ratings" ) {
+                    args >> ratings_file;
+                    continue;
+                }
+                if( arg == "--rating-k" ) {
+                    args >> rating_k;
+                    continue;
+                }
+                if( arg == "--cache" ) {
+                    args >> cache_file;
+                    continue;
+                }
+                if( arg == "--build-id" ) {
+                    args >> build_id;
+                    continue;
+                }
+                if( arg == "--player-build" ) {
+                    std::string value;
+                    args >> value;
+                    std::size_t equals = value.find( '=' );
+                    if( equals == std::string::npos || equals == 0 ) {
+                        std::cerr << "--player-build expects <name>=<string>.\n";
+                        std::exit(1);
+                    }
+                    player_builds[value.substr( 0, equals )] = value.substr( equals + 1 );
+                    continue;
+                }
+                if( arg == "--training-data" ) {
+                    args >> training_data_file;
+                    continue;
+                }
+                if( arg == "--metrics" ) {
+                    args >> metrics_file;
+                    continue;
+                }
+                if( arg == "--metrics-interval" ) {
+                    args >> metrics_interval;
+                    continue;
+                }
+                if( arg == "--checkpoint" ) {
+                    args >> checkpoint_file;
+                    continue;
+                }
+                if( arg == "--checkpoint-interval" ) {
+                    args >> checkpoint_interval;
+                    continue;
+                }
+                if( arg == "--resume" ) {
+                    resume = true;
+                    continue;
+                }
+                if( arg == "--profile" ) {
+                    profile = true;
+                    continue;
+                }
                 if( factories.count(arg) == 1 ) {
                     player_list.push_back( std::make_pair(
                         factories[arg],
                         cmdline::args()
                     ));
+                    player_keys.push_back( { arg } );
                     continue;
                 }
                 if( arg == "" ) {
@@ -118,6 +395,11 @@ namespace core {
                     cmdline::args subargs = args.subarg_until( is_player );
                     subargs.program_name(player);
 
+                    player_keys.push_back( { player } );
+                    cmdline::args copy = subargs;
+                    while( copy.size() > 0 )
+                        player_keys.back().push_back( copy.next() );
+
                     player_list.emplace_back( std::make_pair(
                         factories[player],
                         std::move(subargs)
@@ -133,6 +415,113 @@ namespace core {
 
     void run_several_games();
     void run_single_game();
+    void prepare_checkpoint();
+
+    /* Positions the games start from, used in turn.
+     * If empty, every game starts from the opening.
+     */
+    std::vector< detail::game_state > start_states;
+
+    /* Exits if any of the positions, which came from 'source', is invalid. */
+    void validate_states( const std::string& source,
+            const std::vector< detail::game_state >& states )
+    {
+        for( unsigned i = 0; i < states.size(); i++ )
+            if( const char * problem = detail::validate( states[i], global_player_count() ) ) {
+                std::cerr << source << ": position " << i + 1
+                    << " is invalid: " << problem << ".\n";
+                std::exit(1);
+            }
+    }
+
+    /* Fills start_states according to the command line options. */
+    void prepare_start_states() {
+        using namespace command_line;
+
+        if( !positions_file.empty() ) {
+            std::string error;
+            if( !detail::load_states( positions_file.c_str(),
+                        global_player_count(), start_states, error ) ) {
+                std::cerr << error << "\n";
+                std::exit(1);
+            }
+            validate_states( positions_file, start_states );
+        }
+
+        if( sample_positions > 0 ) {
+            auto sampled = detail::sample_states( sample_positions,
+                    command_line::chopsticks, endgame == 0 ? INT_MAX : endgame, seed );
+            if( (int) sampled.size() < sample_positions )
+                std::cerr << "Only " << sampled.size() << " positions"
+                    << " could be sampled.\n";
+            validate_states( "sampled positions", sampled );
+            start_states.insert( start_states.end(), sampled.begin(), sampled.end() );
+        }
+
+        if( !save_positions_file.empty() &&
+                !detail::save_states( save_positions_file.c_str(), start_states ) ) {
+            std::cerr << "Could not write the positions to " << save_positions_file << ".\n";
+            std::exit(1);
+        }
+
+        if( (!positions_file.empty() || sample_positions > 0) && start_states.empty() ) {
+            std::cerr << "No positions to start the games from.\n";
+            std::exit(1);
+        }
+    }
+
+    /* The checkpoint read by --resume, and whether there was one. */
+    detail::checkpoint::snapshot checkpoint;
+    bool resumed = false;
+
+    /* Reads the checkpoint, if it exists, into 'checkpoint'
+     * and its positions into start_states.
+     */
+    void read_checkpoint() {
+        using namespace command_line;
+
+        if( checkpoint_file.empty() ) {
+            std::cerr << "--resume needs a --checkpoint file.\n";
+            std::exit(1);
+        }
+        /* These outputs are written as the games are played,
+         * so they cannot be rewound to the checkpoint.
+         */
+        if( output_format != detail::record::HUMAN || !training_data_file.empty() ) {
+            std::cerr << "--resume cannot be used with csv/jsonl output"
+                << " or --training-data.\n";
+            std::exit(1);
+        }
+
+        std::string error;
+        if( detail::checkpoint::read( checkpoint_file, global_player_count(),
+                    checkpoint, start_states, error ) ) {
+            validate_states( checkpoint_file + ".positions", start_states );
+            resumed = true;
+            return;
+        }
+        if( !error.empty() ) {
+            std::cerr << error << "\n";
+            std::exit(1);
+        }
+        std::cerr << "No checkpoint in " << checkpoint_file
+            << "; starting from the first game.\n";
+    }
+
+    /* Runs the game of the given index, from its starting position. */
+    std::vector<int> run_game( int game ) {
+        if( start_states.empty() )
+            return detail::run_game( command_line::chopsticks );
+        return detail::run_game( start_states[game % start_states.size()] );
+    }
+
+    /* Feeds the outcome of a game to every consumer of game results
+     * other than the final ranking.
+     */
+    void account_game( int game, const std::vector<int>& ranking ) {
+        detail::record::write_game( game, ranking );
+        detail::rating::update( ranking );
+    }
 
     int play(
         cmdline::args&& args,
@@ -150,38 +539,285 @@ namespace core {
             std::exit(1);
         }
 
+        if( threads < 1 ) {
+            std::cerr << "There must be at least one thread.\n";
+            std::exit(1);
+        }
+        if( threads > 1 )
+            detail::out(null_os);
+
         detail::set_players( std::move(player_list) );
+        detail::set_limits( max_rounds, stall_limit );
+
+        if( resume )
+            read_checkpoint();
+        if( !resumed )
+            prepare_start_states();
+        if( !checkpoint_file.empty() )
+            prepare_checkpoint();
+
+        if( !metrics_file.empty() && metrics_interval <= 0 ) {
+            std::cerr << "The metrics interval must be positive.\n";
+            std::exit(1);
+        }
+
+        if( profile )
+            detail::profile::enable();
+
+        if( !detail::record::open( output_format,
+                    output_file.empty() ? nullptr : output_file.c_str() ) ) {
+            std::cerr << "Could not open " << output_file << " for writing.\n";
+            std::exit(1);
+        }
+
+        if( !ratings_file.empty() &&
+                !detail::rating::load( ratings_file.c_str(), rating_k ) ) {
+            std::cerr << "Malformed ratings file " << ratings_file << ".\n";
+            std::exit(1);
+        }
+
+        if( resumed && !ratings_file.empty() && !checkpoint.ratings.empty() )
+            detail::rating::restore( checkpoint.ratings );
+
+        /* Started last, as their writer threads must be stopped
+         * before the program exits.
+         */
+        if( !metrics_file.empty() &&
+                !detail::metrics::open( metrics_file.c_str(), metrics_interval ) ) {
+            std::cerr << "Could not write " << metrics_file << ".\n";
+            std::exit(1);
+        }
+
+        if( !training_data_file.empty() &&
+                !detail::dataset::open( training_data_file.c_str() ) ) {
+            std::cerr << "Could not open " << training_data_file << " for writing.\n";
+            detail::metrics::close();
+            std::exit(1);
+        }
 
         if( games == 1 )
             run_single_game();
         else
             run_several_games();
 
+        if( !detail::dataset::close() )
+            std::cerr << "Could not write the training data to " << training_data_file << ".\n";
+        detail::metrics::close();
+
+        if( !detail::rating::save() )
+            std::cerr << "Could not write the ratings to " << ratings_file << ".\n";
+
+        if( output_format == detail::record::HUMAN )
+            detail::rating::report( std::cout );
+
+        /* Machine-readable records may be on stdout. */
+        if( profile )
+            detail::profile::report(
+                output_format == detail::record::HUMAN ? std::cout : std::clog );
+
         return 0;
     }
 
+    /* Closes the csv or jsonl records, reporting write errors. */
+    void close_records() {
+        if( !detail::record::close() )
+            std::cerr << "Could not write the records to "
+                << (command_line::output_file.empty() ? "stdout" : command_line::output_file)
+                << ".\n";
+    }
+
     void run_single_game() {
-        auto ranking = detail::run_game( command_line::chopsticks );
+        auto ranking = run_game( 0 );
+        account_game( 0, ranking );
+
+        if( command_line::output_format != detail::record::HUMAN ) {
+            close_records();
+            return;
+        }
 
         std::cout << "\n\tRanking:\n";
+        if( detail::truncated )
+            std::cout << "(game truncated after "
+                << detail::round_count << " rounds)\n";
         for( unsigned i = 0; i < ranking.size(); i++ )
             std::cout << '[' << ranking[i] << "] "
                 << player(ranking[i])->name() << '\n';
     }
 
+    /* Key that identifies this matchup in the results cache. */
+    detail::cache::key matchup_key() {
+        const std::string & build_id = command_line::build_id;
+        detail::cache::key key;
+        key.add( build_id.empty() ? detail::cache::build_identity() : build_id );
+        key.add( command_line::chopsticks );
+        key.add( command_line::games );
+        key.add( command_line::max_rounds );
+        key.add( command_line::stall_limit );
+        key.add( (long long) start_states.size() );
+        for( const auto & state : start_states ) {
+            key.add( state.starting_player );
+            key.add( state.last_winner );
+            for( int c : state.chopsticks )
+                key.add( c );
+            for( int h : state.last_hand )
+                key.add( h );
+        }
+        for( const auto & player : command_line::player_keys ) {
+            key.add( (long long) player.size() );
+            for( const auto & str : player )
+                key.add( str );
+            auto build = command_line::player_builds.find( player[0] );
+            key.add( build == command_line::player_builds.end() ? std::string() : build->second );
+        }
+        return key;
+    }
+
+    /* Serializes the accounting of games played by different threads. */
+    std::mutex account_mutex;
+
+    /* Number of games accounted in the tally, including resumed ones. */
+    int games_completed = 0;
+
+    /* Key of this run, stored in the checkpoints. */
+    detail::cache::key run_key;
+
+    /* Checks the checkpoint options against the checkpoint read by --resume,
+     * computes run_key and writes the positions of a new run.
+     * Called before any thread is started, so it may exit.
+     */
+    void prepare_checkpoint() {
+        if( command_line::checkpoint_interval < 1 ) {
+            std::cerr << "The checkpoint interval must be positive.\n";
+            std::exit(1);
+        }
+
+        run_key = matchup_key();
+        if( resumed && checkpoint.key != run_key.value() ) {
+            std::cerr << "The checkpoint " << command_line::checkpoint_file
+                << " is from a different run.\n";
+            std::exit(1);
+        }
+
+        if( !resumed && !start_states.empty() &&
+                !detail::checkpoint::write_positions( command_line::checkpoint_file, start_states ) ) {
+            std::cerr << "Could not write the positions of the checkpoint "
+                << command_line::checkpoint_file << ".\n";
+            std::exit(1);
+        }
+    }
+
+    /* Saves a checkpoint in the background.
+     * Must be called with account_mutex locked,
+     * so it only copies the tally and the ratings.
+     */
+    void save_checkpoint( const detail::cache::results& tally ) {
+        detail::checkpoint::snapshot s;
+        s.key = run_key.value();
+        s.games_completed = games_completed;
+        s.tally = tally;
+        s.position_count = start_states.size();
+        s.ratings = detail::rating::snapshot();
+        detail::checkpoint::write( command_line::checkpoint_file, std::move(s) );
+    }
+
+    /* Plays the games from next_game up to command_line::games,
+     * adding their results to the tally.
+     * Several threads may call this function at once,
+     * each with its own set of players.
+     */
+    void play_games( std::atomic<int>& next_game, detail::cache::results& tally ) {
+        for( int game; (game = next_game++) < command_line::games; ) {
+            auto ranking = run_game( game );
+
+            std::lock_guard< std::mutex > lock( account_mutex );
+            tally.first[ranking[0]]++;
+            tally.second[ranking[1]]++;
+            if( ranking.size() >= 3 )
+                tally.third[ranking[2]]++;
+            tally.truncated += detail::truncated;
+            account_game( game, ranking );
+
+            games_completed++;
+            if( !command_line::checkpoint_file.empty() &&
+                    games_completed % command_line::checkpoint_interval == 0 )
+                save_checkpoint( tally );
+        }
+    }
+
     void run_several_games() {
-        std::vector< int > first( global_player_count() );
-        std::vector< int > second( global_player_count() );
-        std::vector< int > third( global_player_count() );
+        /* The cache only holds the final tally,
+         * so it cannot stand in for runs that also need every game.
+         */
+        bool use_cache = !command_line::cache_file.empty()
+            && command_line::output_format == detail::record::HUMAN
+            && command_line::ratings_file.empty()
+            && command_line::training_data_file.empty();
+
+        bool use_checkpoint = !command_line::checkpoint_file.empty();
 
-        for( int game = 0; game < command_line::games; game++ ) {
-            auto ranking = detail::run_game( command_line::chopsticks );
-            first[ranking[0]]++;
-            second[ranking[1]]++;
-            if( global_player_count() >= 3 )
-                third[ranking[2]]++;
+        detail::cache::key key;
+        detail::cache::results tally;
+        bool cached = false;
+        if( use_cache ) {
+            key = use_checkpoint ? run_key : matchup_key();
+            cached = detail::cache::lookup( command_line::cache_file.c_str(), key,
+                    global_player_count(), tally );
         }
 
+        if( cached )
+            std::cout << "Results read from the cache.\n";
+        else {
+            if( resumed ) {
+                tally = checkpoint.tally;
+                games_completed = checkpoint.games_completed;
+            }
+            else {
+                tally.first.assign( global_player_count(), 0 );
+                tally.second.assign( global_player_count(), 0 );
+                tally.third.assign( global_player_count(), 0 );
+            }
+
+            std::atomic<int> next_game( games_completed );
+            detail::player_sets->reserve( command_line::threads - 1 );
+
+            std::vector< std::thread > workers;
+            for( int i = 1; i < command_line::threads; i++ )
+                workers.emplace_back( [&next_game, &tally]{
+                    std::ostream worker_null_os(0);
+                    detail::out( worker_null_os );
+                    detail::players = detail::player_sets->acquire();
+
+                    play_games( next_game, tally );
+
+                    detail::profile::merge();
+                    detail::player_sets->release( std::move(detail::players) );
+                });
+
+            play_games( next_game, tally );
+            for( auto & worker : workers )
+                worker.join();
+
+            if( use_checkpoint ) {
+                detail::checkpoint::wait();
+                save_checkpoint( tally );
+                if( !detail::checkpoint::wait() )
+                    std::cerr << "Could not write the checkpoint "
+                        << command_line::checkpoint_file << ".\n";
+            }
+
+            if( use_cache && !detail::cache::store( command_line::cache_file.c_str(), key, tally ) )
+                std::cerr << "Could not write to the cache " << command_line::cache_file << ".\n";
+        }
+
+        if( command_line::output_format != detail::record::HUMAN ) {
+            close_records();
+            return;
+        }
+
+        const auto & first = tally.first;
+        const auto & second = tally.second;
+        const auto & third = tally.third;
+
         if( global_player_count() >= 3 ) {
             std::cout << "Player - First places / second / third\n";
             for( int p = 0; p < global_player_count(); p++ )
@@ -196,6 +832,10 @@ namespace core {
                 std::cout << player(p)->name() << " - "
                     << first[p] << "\n";
         }
+
+        if( tally.truncated != 0 )
+            std::cout << "Truncated games: " << tally.truncated
+                << " of " << command_line::games << "\n";
     }
 
 } // namespace core
@@ -1,3 +1,5 @@
+#include <map>
+#include <mutex>
 #include "util.h"
 #include "core/detail/variables.h"
 
@@ -6,6 +8,33 @@ namespace core {
         return detail::players.size();
     }
 
+    namespace detail {
+        std::shared_ptr<const void> shared_data(
+            const std::string& key,
+            const std::function< std::shared_ptr<const void>() >& load
+        ) {
+            struct entry {
+                std::once_flag loaded;
+                std::shared_ptr<const void> data;
+            };
+            static std::mutex mutex;
+            static std::map< std::string, std::shared_ptr<entry> > entries;
+
+            std::shared_ptr<entry> e;
+            {
+                std::lock_guard< std::mutex > lock( mutex );
+                auto & slot = entries[key];
+                if( !slot )
+                    slot = std::make_shared<entry>();
+                e = slot;
+            }
+
+            // Loads of different keys may proceed concurrently.
+            std::call_once( e->loaded, [&]{ e->data = load(); } );
+            return e->data;
+        }
+    } // namespace detail
+
     int player_count() {
         return detail::chopsticks.size();
     }
@@ -48,10 +77,25 @@ namespace core {
     bool valid_guess( int possible_guess ) {
         if( possible_guess < 0 || possible_guess > chopstick_count() )
             return false;
-        for( auto guess: detail::guesses )
-            if( guess == possible_guess )
-                return false;
-        return true;
+        const std::vector<int>& guessed_by = detail::round_context.guessed_by;
+        return possible_guess >= (int) guessed_by.size() || guessed_by[possible_guess] == -1;
+    }
+
+    std::vector<int> RoundContext::free_guesses() const {
+        std::vector<int> values;
+        values.reserve( free_guess_count );
+        for( int v = 0; v <= chopstick_count && v < (int) guessed_by.size(); v++ )
+            if( guessed_by[v] == -1 )
+                values.push_back( v );
+        return values;
+    }
+
+    int RoundContext::max_sum( int player_index, int hand ) const {
+        return hand + chopstick_count - detail::chopsticks[player_index];
+    }
+
+    const RoundContext& round_context() {
+        return detail::round_context;
     }
 
     const std::vector<int>& hand() {
@@ -11,6 +11,9 @@
  * These call times are described in each section.
  */
 
+#include <functional>
+#include <memory>
+#include <string>
 #include "player.h"
 
 namespace core {
@@ -29,6 +32,21 @@ namespace core {
      */
     int global_player_count();
 
+    /* Returns the object stored under 'key';
+     * if there is none, 'load()' is called to create it.
+     * 'load' must return either a T * allocated with new
+     * or a std::shared_ptr<T>.
+     *
+     * Intended for large read-only data (tables, models)
+     * needed by every instance of a player:
+     * when several games run in parallel, each with its own instances,
+     * the data is loaded once per process and shared among them.
+     * 'load' is called at most once per key, even by concurrent callers;
+     * the others wait for it to finish.
+     */
+    template< typename T, typename Loader >
+    std::shared_ptr<const T> shared_data( const std::string& key, Loader load );
+
 /* Overall game queries
  *
  * This infromation exists "internally" in a game.
@@ -143,6 +161,57 @@ namespace core {
      */
     bool valid_guess( int possible_guess );
 
+    /* Facts about the current round that every player would otherwise
+     * recompute from chopsticks(), guess() and chopstick_count().
+     *
+     * The engine builds it once at the beginning of the round
+     * and updates it as each guess arrives,
+     * so each query below costs O(1) instead of a scan of the table.
+     */
+    struct RoundContext {
+        /* Same as core::chopstick_count(). */
+        int chopstick_count;
+
+        /* Number of players that still have to guess this round,
+         * including the one currently guessing.
+         */
+        int pending_guesses;
+
+        /* Number of values between 0 and chopstick_count
+         * that no one has guessed yet.
+         */
+        int free_guess_count;
+
+        /* guessed_by[v] is the index of the player that guessed v,
+         * or -1 if no one did. Its size is chopstick_count + 1.
+         */
+        std::vector<int> guessed_by;
+
+        /* Whether 'value' is a valid guess this round;
+         * same as core::valid_guess(value) while the players guess.
+         */
+        bool is_free( int value ) const {
+            return value >= 0 && value <= chopstick_count
+                && value < (int) guessed_by.size() && guessed_by[value] == -1;
+        }
+
+        /* Every value that is still a valid guess, in increasing order. */
+        std::vector<int> free_guesses() const;
+
+        /* Smallest and largest possible sums of all hands,
+         * given that the player at 'player_index' holds 'hand' chopsticks.
+         */
+        int min_sum( int hand ) const {
+            return hand;
+        }
+        int max_sum( int player_index, int hand ) const;
+    };
+
+    /* Returns the context of the current round.
+     * It reflects every guess made so far in this round.
+     */
+    const RoundContext& round_context();
+
 /* End round information
  *
  * Information that becomes avaliable only at the end of a round.
@@ -169,5 +238,22 @@ namespace core {
      */
     int last_winner();
 
+/* Implementation of the templates above. */
+namespace detail {
+    std::shared_ptr<const void> shared_data(
+        const std::string& key,
+        const std::function< std::shared_ptr<const void>() >& load
+    );
+} // namespace detail
+
+    template< typename T, typename Loader >
+    std::shared_ptr<const T> shared_data( const std::string& key, Loader load ) {
+        return std::static_pointer_cast<const T>( detail::shared_data( key,
+            [&load]() -> std::shared_ptr<const void> {
+                return std::shared_ptr<const T>( load() );
+            }
+        ));
+    }
+
 } // namespace core
 #endif // CORE_UTIL_H